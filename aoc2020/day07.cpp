@@ -1,72 +1,22 @@
+#include "day07.hpp"
 #include "input_helpers.hpp"
-#include "range_helpers.hpp"
-#include <regex>
+#include <iostream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
-#include <ranges>
-
-using bag_contained_by_graph = std::unordered_multimap<std::string, std::string>;
-using bag_contains_graph = std::unordered_multimap<std::string, std::pair<int, std::string>>;
-
-void add_to_graphs(bag_contained_by_graph& contained_by, bag_contains_graph& contains, std::string const& line) {
-    static std::regex const prefix_regex(R"(^(.*?) bags contain)");
-    static std::regex const contents_regex(R"((\d+) (.*?) bags?)");
-
-    std::string container;
-    std::smatch m;
-    if (std::regex_search(line, m, prefix_regex) && m.size() > 1) {
-        container = m[1];
-    } else {
-        return;
-    }
-
-    for (auto const& match : std::ranges::subrange(std::sregex_iterator(line.begin(), line.end(), contents_regex), std::sregex_iterator{})) {
-        if (match.size() > 2) {
-            contained_by.emplace(match[2], container);
-            int const count = std::atoi(match[1].str().c_str());
-            contains.emplace(container, std::pair(count, match[2]));
-        }
-    }
-}
-
-void contained_by_dfs(bag_contained_by_graph const& contained_by, std::string const& node, std::unordered_set<std::string>& visited) {
-    visited.insert(node);
-    for (auto const& [_, container] : pairseq(contained_by.equal_range(node))) {
-        if (visited.count(container) == 0) {
-            contained_by_dfs(contained_by, container, visited);
-        }
-    }
-}
-
-size_t nr_contained_by(bag_contained_by_graph const& contained_by, std::string const& start) {
-    std::unordered_set<std::string> visited;
-    contained_by_dfs(contained_by, start, visited);
-    return visited.size() - 1;
-}
-
-size_t contains_dfs(bag_contains_graph const& contains, std::string const& node) {
-    size_t total_contents = 1;
-    for (auto const& [_, contents] : pairseq(contains.equal_range(node))) {
-        int const count = contents.first;
-        std::string const& type = contents.second;
-        total_contents += count * contains_dfs(contains, type);
-    }
-    return total_contents;
-}
-
-size_t nr_contains(bag_contains_graph const& contains, std::string const& start) {
-    return contains_dfs(contains, start) - 1;
-}
 
 void run() {
-    bag_contained_by_graph contained_by;
-    bag_contains_graph contains;
+    bag_graph_builder builder;
     for (std::string const& line : input_lines(std::cin)) {
-        add_to_graphs(contained_by, contains, line);
+        builder.add_rule(parse_rule(line));
+    }
+    bag_graph const graph = builder.build();
+
+    bag_id const shiny_gold = graph.id("shiny gold");
+    if (shiny_gold < 0) {
+        std::cout << "No shiny gold bag!" << std::endl;
+        return;
     }
 
-    std::cout << nr_contained_by(contained_by, "shiny gold") << std::endl;
+    std::cout << containment_index(graph).nr_contained_by(shiny_gold) << std::endl;
 
-    std::cout << nr_contains(contains, "shiny gold") << std::endl;
+    std::cout << nr_contains(bag_totals(graph), shiny_gold) << std::endl;
 }
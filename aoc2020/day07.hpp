@@ -0,0 +1,430 @@
+#pragma once
+
+#include "range_helpers.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <numeric>
+#include <ranges>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using bag_id = int;
+
+struct bag_rule {
+    std::string container;
+    std::vector<std::pair<int, std::string>> contents;
+};
+
+inline bag_rule parse_rule(std::string const& line) {
+    static std::regex const prefix_regex(R"(^(.*?) bags contain)");
+    static std::regex const contents_regex(R"((\d+) (.*?) bags?)");
+
+    bag_rule rule;
+    std::smatch m;
+    if (std::regex_search(line, m, prefix_regex) && m.size() > 1) {
+        rule.container = m[1];
+    } else {
+        return {};
+    }
+
+    for (auto const& match : std::ranges::subrange(std::sregex_iterator(line.begin(), line.end(), contents_regex), std::sregex_iterator{})) {
+        if (match.size() > 2) {
+            int const count = std::atoi(match[1].str().c_str());
+            rule.contents.emplace_back(count, match[2]);
+        }
+    }
+    return rule;
+}
+
+struct bag_edge {
+    int count{};
+    bag_id bag{};
+};
+
+// A bag graph that can be edited one rule at a time. Answers are cached per bag, and an edit only
+// invalidates the bags whose answers it can change: the containers of the edited bag for contents
+// counts, and the contents of the edited bag for container counts. Bags on a cycle, and bags
+// containing one, contain 0 bags, as in bag_totals.
+class mutable_bag_graph {
+public:
+    // Adding a rule for a bag that already has one replaces it.
+    void add_rule(bag_rule const& rule) {
+        if (rule.container.empty()) {
+            return;
+        }
+        bag_id const container = intern(rule.container);
+        if (!_contents[container].empty()) {
+            remove_rule(rule.container);
+        }
+        for (auto const& [count, name] : rule.contents) {
+            bag_id const bag = intern(name);
+            _contents[container].push_back({count, bag});
+            _containers[bag].push_back(container);
+        }
+        invalidate_containers(container);
+        invalidate_contents(container);
+    }
+
+    void remove_rule(std::string const& container_name) {
+        auto it = _ids.find(container_name);
+        if (it == _ids.end()) {
+            return;
+        }
+        bag_id const container = it->second;
+        invalidate_containers(container);
+        invalidate_contents(container);
+        for (auto const& edge : _contents[container]) {
+            auto& containers = _containers[edge.bag];
+            containers.erase(std::find(containers.begin(), containers.end(), container));
+        }
+        _contents[container].clear();
+    }
+
+    void replace_rule(bag_rule const& rule) {
+        add_rule(rule);
+    }
+
+    size_t nr_contains(std::string const& name) {
+        auto it = _ids.find(name);
+        if (it == _ids.end()) {
+            return 0;
+        }
+        size_t const t = total(it->second);
+        return t != cyclic ? t - 1 : 0;
+    }
+
+    size_t nr_contained_by(std::string const& name) {
+        auto it = _ids.find(name);
+        if (it == _ids.end()) {
+            return 0;
+        }
+        bag_id const start = it->second;
+        if (_contained_by[start] == unknown) {
+            begin_search();
+            _stack.push_back(start);
+            size_t count = 0;
+            while (!_stack.empty()) {
+                bag_id const bag = _stack.back();
+                _stack.pop_back();
+                for (bag_id container : _containers[bag]) {
+                    if (visit(container)) {
+                        count += (container != start);
+                        _stack.push_back(container);
+                    }
+                }
+            }
+            _contained_by[start] = count;
+        }
+        return _contained_by[start];
+    }
+
+private:
+    bag_id intern(std::string const& name) {
+        auto [it, inserted] = _ids.emplace(name, static_cast<bag_id>(_contents.size()));
+        if (inserted) {
+            _contents.emplace_back();
+            _containers.emplace_back();
+            _totals.push_back(unknown);
+            _contained_by.push_back(unknown);
+            _visited.push_back(0);
+        }
+        return it->second;
+    }
+
+    // Searches mark bags with the current epoch instead of clearing a visited array, so a search
+    // costs only the bags it reaches.
+    void begin_search() {
+        if (++_epoch == 0) {
+            std::fill(_visited.begin(), _visited.end(), 0);
+            _epoch = 1;
+        }
+    }
+
+    bool visit(bag_id bag) {
+        if (_visited[bag] == _epoch) {
+            return false;
+        }
+        _visited[bag] = _epoch;
+        return true;
+    }
+
+    void invalidate_containers(bag_id bag) {
+        // A known total implies known totals for all contents, so once an unknown total is found
+        // all of its containers are unknown already.
+        if (_totals[bag] == unknown) {
+            return;
+        }
+        _totals[bag] = unknown;
+        for (bag_id container : _containers[bag]) {
+            invalidate_containers(container);
+        }
+    }
+
+    void invalidate_contents(bag_id start) {
+        begin_search();
+        visit(start);
+        _stack.push_back(start);
+        while (!_stack.empty()) {
+            bag_id const bag = _stack.back();
+            _stack.pop_back();
+            _contained_by[bag] = unknown;
+            for (auto const& edge : _contents[bag]) {
+                if (visit(edge.bag)) {
+                    _stack.push_back(edge.bag);
+                }
+            }
+        }
+    }
+
+    // The total number of bags in a bag, counting itself, or `cyclic` if the bag is on a cycle
+    // or contains one; there is no finite answer then. Every content is resolved even after a
+    // cycle is found, so that a cached total always implies cached totals for all contents.
+    size_t total(bag_id bag) {
+        if (_totals[bag] == in_progress) {
+            return cyclic;
+        } else if (_totals[bag] != unknown) {
+            return _totals[bag];
+        }
+        _totals[bag] = in_progress;
+        size_t sum = 1;
+        for (auto const& edge : _contents[bag]) {
+            size_t const contents = total(edge.bag);
+            sum = sum == cyclic || contents == cyclic ? cyclic : sum + edge.count * contents;
+        }
+        _totals[bag] = sum;
+        return sum;
+    }
+
+    std::unordered_map<std::string, bag_id> _ids;
+    std::vector<std::vector<bag_edge>> _contents;
+    std::vector<std::vector<bag_id>> _containers;
+
+    static constexpr size_t unknown = -1;
+    static constexpr size_t in_progress = -2;
+    static constexpr size_t cyclic = -3;
+    std::vector<size_t> _totals;
+    std::vector<size_t> _contained_by;
+
+    std::vector<uint32_t> _visited;
+    uint32_t _epoch = 0;
+    std::vector<bag_id> _stack;
+};
+
+// Both directions of the bag graph, stored as compressed sparse rows: the edges of bag b are
+// contains[contains_offsets[b] .. contains_offsets[b+1]), and likewise for contained_by.
+struct bag_graph {
+    std::unordered_map<std::string, bag_id> ids;
+    std::vector<std::string> names;
+    std::vector<size_t> contains_offsets{0};
+    std::vector<bag_edge> contains;
+    std::vector<size_t> contained_by_offsets{0};
+    std::vector<bag_id> contained_by;
+
+    [[nodiscard]] size_t size() const {
+        return names.size();
+    }
+
+    [[nodiscard]] bag_id id(std::string const& name) const {
+        auto it = ids.find(name);
+        return it != ids.end() ? it->second : -1;
+    }
+
+    [[nodiscard]] auto contents_of(bag_id bag) const {
+        return pairseq(contains.begin() + contains_offsets[bag], contains.begin() + contains_offsets[bag+1]);
+    }
+
+    [[nodiscard]] auto containers_of(bag_id bag) const {
+        return pairseq(contained_by.begin() + contained_by_offsets[bag], contained_by.begin() + contained_by_offsets[bag+1]);
+    }
+};
+
+class bag_graph_builder {
+public:
+    bag_id intern(std::string const& name) {
+        auto [it, inserted] = _graph.ids.emplace(name, static_cast<bag_id>(_graph.names.size()));
+        if (inserted) {
+            _graph.names.push_back(name);
+        }
+        return it->second;
+    }
+
+    void add_rule(bag_rule const& rule) {
+        if (rule.container.empty()) {
+            return;
+        }
+        bag_id const container = intern(rule.container);
+        for (auto const& [count, name] : rule.contents) {
+            _edges.push_back({container, {count, intern(name)}});
+        }
+    }
+
+    bag_graph build() {
+        size_t const n = _graph.names.size();
+        _graph.contains_offsets.assign(n + 1, 0);
+        _graph.contained_by_offsets.assign(n + 1, 0);
+        for (auto const& [container, edge] : _edges) {
+            _graph.contains_offsets[container + 1]++;
+            _graph.contained_by_offsets[edge.bag + 1]++;
+        }
+        std::partial_sum(_graph.contains_offsets.begin(), _graph.contains_offsets.end(), _graph.contains_offsets.begin());
+        std::partial_sum(_graph.contained_by_offsets.begin(), _graph.contained_by_offsets.end(), _graph.contained_by_offsets.begin());
+
+        _graph.contains.resize(_edges.size());
+        _graph.contained_by.resize(_edges.size());
+        std::vector<size_t> contains_fill(_graph.contains_offsets.begin(), _graph.contains_offsets.end() - 1);
+        std::vector<size_t> contained_by_fill(_graph.contained_by_offsets.begin(), _graph.contained_by_offsets.end() - 1);
+        for (auto const& [container, edge] : _edges) {
+            _graph.contains[contains_fill[container]++] = edge;
+            _graph.contained_by[contained_by_fill[edge.bag]++] = container;
+        }
+        return std::move(_graph);
+    }
+
+private:
+    bag_graph _graph;
+    std::vector<std::pair<bag_id, bag_edge>> _edges;
+};
+
+// Answers "how many bags can eventually contain this bag" in O(1). Bags are collapsed into
+// strongly connected components, so cyclic rules are handled, and the set of containers of each
+// component is kept as a bitset row, filled outermost component first.
+class containment_index {
+public:
+    explicit containment_index(bag_graph const& graph)
+            : _words((graph.size() + 63) / 64)
+            , _component(graph.size(), -1)
+            , _lowlink(graph.size())
+            , _on_stack(graph.size())
+    {
+        for (bag_id bag = 0; bag < static_cast<bag_id>(graph.size()); ++bag) {
+            if (_component[bag] < 0 && _lowlink[bag] == 0) {
+                strong_connect(graph, bag);
+            }
+        }
+
+        _counts.resize(graph.size());
+        for (bag_id bag = 0; bag < static_cast<bag_id>(graph.size()); ++bag) {
+            uint64_t const* r = row(_component[bag]);
+            size_t count = 0;
+            for (size_t w = 0; w < _words; ++w) {
+                count += std::popcount(r[w]);
+            }
+            _counts[bag] = count - ((r[bag / 64] >> (bag % 64)) & 1);
+        }
+        _lowlink = {};
+        _on_stack = {};
+        _stack = {};
+    }
+
+    [[nodiscard]] size_t nr_contained_by(bag_id bag) const {
+        return _counts[bag];
+    }
+
+private:
+    uint64_t* row(int component) {
+        return &_rows[component * _words];
+    }
+
+    uint64_t const* row(int component) const {
+        return &_rows[component * _words];
+    }
+
+    void set_bit(uint64_t* r, bag_id bag) {
+        r[bag / 64] |= uint64_t{1} << (bag % 64);
+    }
+
+    // Tarjan's algorithm. Components are completed in reverse topological order, so the rows of
+    // all containing components are already filled in when a component is finished.
+    void strong_connect(bag_graph const& graph, bag_id bag) {
+        _lowlink[bag] = ++_next_index;
+        size_t const index = _lowlink[bag];
+        _stack.push_back(bag);
+        _on_stack[bag] = true;
+        for (bag_id container : graph.containers_of(bag)) {
+            if (_component[container] < 0 && _lowlink[container] == 0) {
+                strong_connect(graph, container);
+                _lowlink[bag] = std::min(_lowlink[bag], _lowlink[container]);
+            } else if (_on_stack[container]) {
+                _lowlink[bag] = std::min(_lowlink[bag], _lowlink[container]);
+            }
+        }
+        if (_lowlink[bag] != index) {
+            return;
+        }
+
+        int const component = _next_component++;
+        _rows.resize(_rows.size() + _words);
+        std::vector<bag_id> members;
+        bag_id member{};
+        do {
+            member = _stack.back();
+            _stack.pop_back();
+            _on_stack[member] = false;
+            _component[member] = component;
+            members.push_back(member);
+        } while (member != bag);
+
+        uint64_t* const r = row(component);
+        for (bag_id m : members) {
+            for (bag_id container : graph.containers_of(m)) {
+                int const other = _component[container];
+                if (other != component) {
+                    uint64_t const* const other_row = row(other);
+                    for (size_t w = 0; w < _words; ++w) {
+                        r[w] |= other_row[w];
+                    }
+                }
+                set_bit(r, container);
+            }
+        }
+    }
+
+    size_t _words;
+    std::vector<int> _component;
+    std::vector<uint64_t> _rows;
+    std::vector<size_t> _counts;
+    std::vector<size_t> _lowlink;
+    std::vector<bool> _on_stack;
+    std::vector<bag_id> _stack;
+    size_t _next_index = 0;
+    int _next_component = 0;
+};
+
+// The total number of bags in each bag, counting the bag itself. Bags are resolved in topological
+// order, innermost first, so every bag is expanded exactly once. Bags on or containing a cycle
+// are left at 0.
+inline std::vector<size_t> bag_totals(bag_graph const& graph) {
+    std::vector<size_t> unresolved(graph.size());
+    std::vector<bag_id> ready;
+    for (bag_id bag = 0; bag < static_cast<bag_id>(graph.size()); ++bag) {
+        unresolved[bag] = graph.contains_offsets[bag+1] - graph.contains_offsets[bag];
+        if (unresolved[bag] == 0) {
+            ready.push_back(bag);
+        }
+    }
+
+    std::vector<size_t> totals(graph.size(), 0);
+    while (!ready.empty()) {
+        bag_id const bag = ready.back();
+        ready.pop_back();
+
+        totals[bag] = 1;
+        for (auto const& [count, contents] : graph.contents_of(bag)) {
+            totals[bag] += count * totals[contents];
+        }
+        for (bag_id container : graph.containers_of(bag)) {
+            if (--unresolved[container] == 0) {
+                ready.push_back(container);
+            }
+        }
+    }
+    return totals;
+}
+
+inline size_t nr_contains(std::vector<size_t> const& totals, bag_id start) {
+    return totals[start] > 0 ? totals[start] - 1 : 0;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <deque>
+#include <optional>
+#include <ranges>
+#include <unordered_map>
+
+// The last `window` numbers of an XMAS stream, with a count of each value so that pair sums can be
+// checked in O(window) rather than O(window^2).
+class xmas_window {
+public:
+    explicit xmas_window(size_t window)
+            : _window(window)
+    {}
+
+    [[nodiscard]] bool is_full() const {
+        return _numbers.size() == _window;
+    }
+
+    [[nodiscard]] bool has_match(long number) const {
+        for (long x : _numbers) {
+            auto it = _counts.find(number - x);
+            if (it != _counts.end() && (number - x != x || it->second > 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Returns whether the number is valid: either part of the preamble, or the sum of a pair in
+    // the window.
+    bool push(long number) {
+        bool const valid = !is_full() || has_match(number);
+        _numbers.push_back(number);
+        _counts[number]++;
+        if (_numbers.size() > _window) {
+            auto it = _counts.find(_numbers.front());
+            if (--it->second == 0) {
+                _counts.erase(it);
+            }
+            _numbers.pop_front();
+        }
+        return valid;
+    }
+
+private:
+    size_t _window;
+    std::deque<long> _numbers;
+    std::unordered_map<long, int> _counts;
+};
+
+template<std::ranges::input_range Range>
+long find_invalid(Range&& numbers, size_t preamble_length) {
+    xmas_window window(preamble_length);
+    for (long number : numbers) {
+        if (!window.push(number)) {
+            return number;
+        }
+    }
+    return -1;
+}
+
+struct xmas_range {
+    size_t first{};
+    size_t last{};
+    long smallest{};
+    long largest{};
+};
+
+// Finds a run of at least two consecutive numbers summing to the target in one pass, with two
+// pointers over the stream. The minimum and maximum of the current run are kept in monotonic
+// deques, so nothing is rescanned. Only works for non-negative numbers, which XMAS streams are.
+class xmas_range_finder {
+public:
+    explicit xmas_range_finder(long target)
+            : _target(target)
+    {}
+
+    // Returns true once the numbers pushed so far end with a matching run.
+    bool push(long number) {
+        _run.push_back(number);
+        _sum += number;
+        while (!_smallest.empty() && _smallest.back() > number) {
+            _smallest.pop_back();
+        }
+        _smallest.push_back(number);
+        while (!_largest.empty() && _largest.back() < number) {
+            _largest.pop_back();
+        }
+        _largest.push_back(number);
+        ++_end;
+
+        while (_sum > _target && !_run.empty()) {
+            long const front = _run.front();
+            _run.pop_front();
+            _sum -= front;
+            if (_smallest.front() == front) {
+                _smallest.pop_front();
+            }
+            if (_largest.front() == front) {
+                _largest.pop_front();
+            }
+        }
+        return _sum == _target && _run.size() >= 2;
+    }
+
+    [[nodiscard]] xmas_range range() const {
+        return {_end - _run.size(), _end - 1, _smallest.front(), _largest.front()};
+    }
+
+private:
+    long _target;
+    long _sum = 0;
+    size_t _end = 0;
+    std::deque<long> _run;
+    std::deque<long> _smallest;
+    std::deque<long> _largest;
+};
+
+template<std::ranges::input_range Range>
+std::optional<xmas_range> find_range_summing_to(Range&& numbers, long target) {
+    xmas_range_finder finder(target);
+    for (long number : numbers) {
+        if (finder.push(number)) {
+            return finder.range();
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "input_helpers.hpp"
+#include "numtheory.hpp"
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+inline std::vector<int> read_adapters(std::istream& is) {
+    std::vector<int> adapters;
+    std::transform(
+            input_line_iterator{is},
+            input_line_iterator{},
+            std::back_inserter(adapters),
+            [](std::string const& line) {
+                return atoi(line.c_str());
+            });
+    return adapters;
+}
+
+// Sorted, distinct adapter ratings. A dense range is counting sorted through a presence bitmap;
+// a sparse one falls back to a comparison sort, so large ratings don't need large tables.
+inline std::vector<int> sorted_adapters(std::vector<int> const& adapters) {
+    if (adapters.empty()) {
+        return {};
+    }
+    auto const [min, max] = std::minmax_element(adapters.begin(), adapters.end());
+    size_t const range = static_cast<size_t>(*max) - static_cast<size_t>(*min) + 1;
+    if (range <= 8 * adapters.size() + 1024) {
+        std::vector<bool> present(range);
+        for (int adapter : adapters) {
+            present[adapter - *min] = true;
+        }
+        std::vector<int> sorted;
+        for (size_t i = 0; i < range; ++i) {
+            if (present[i]) {
+                sorted.push_back(*min + static_cast<int>(i));
+            }
+        }
+        return sorted;
+    } else {
+        auto sorted = adapters;
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        return sorted;
+    }
+}
+
+inline std::tuple<int, int, int> adapter_diffs(std::vector<int> const& sorted_adapters) {
+    int input_jolts = 0;
+    int diff1 = 0;
+    int diff2 = 0;
+    int diff3 = 0;
+    for (int adapter : sorted_adapters) {
+        if (adapter - input_jolts == 1) {
+            diff1++;
+        } else if (adapter - input_jolts == 2) {
+            diff2++;
+        } else if (adapter - input_jolts == 3) {
+            diff3++;
+        } else {
+            std::cout << "Bad adapter! in: " << input_jolts << ", adapter: " << adapter << std::endl;
+            return {-1, -1, -1};
+        }
+        input_jolts = adapter;
+    }
+    return {diff1, diff2, diff3};
+}
+
+// The number of chains from the outlet (0 jolts) through sorted, distinct adapters to the device,
+// where each step may go up by at most max_gap jolts. The device sits max_gap above the largest
+// adapter, so only that adapter reaches it. Only the (jolts, chain count) pairs of the last max_gap
+// jolts are kept, as a sliding window with a running sum; `add` and `subtract` supply the arithmetic
+// on Count. Memory stays O(max_gap) counts, however many adapters there are.
+template<class Count, class Add, class Subtract>
+Count sliding_chain_count(std::vector<int> const& sorted_adapters, int max_gap, Add add, Subtract subtract) {
+    std::deque<std::pair<int, Count>> window;
+    window.emplace_back(0, Count(1));
+    Count window_sum(1);
+    for (int jolts : sorted_adapters) {
+        while (!window.empty() && jolts - window.front().first > max_gap) {
+            window_sum = subtract(window_sum, window.front().second);
+            window.pop_front();
+        }
+        Count chains = window_sum;
+        window_sum = add(window_sum, chains);
+        window.emplace_back(jolts, std::move(chains));
+    }
+    return window.back().second;
+}
+
+// The exact number of chains; it grows exponentially with the number of adapters.
+inline big_unsigned count_chains(std::vector<int> const& sorted_adapters, int max_gap = 3) {
+    return sliding_chain_count<big_unsigned>(
+            sorted_adapters, max_gap,
+            [](big_unsigned x, big_unsigned const& y) { return x += y; },
+            [](big_unsigned x, big_unsigned const& y) { return x -= y; });
+}
+
+// The number of chains modulo `modulus`, which must be in [1, 2^63).
+inline size_t count_chains_modulo(std::vector<int> const& sorted_adapters, int max_gap, size_t modulus) {
+    return sliding_chain_count<size_t>(
+            sorted_adapters, max_gap,
+            [modulus](size_t x, size_t y) { return (x + y) % modulus; },
+            [modulus](size_t x, size_t y) { return (x + modulus - y % modulus) % modulus; });
+}
@@ -0,0 +1,526 @@
+#pragma once
+
+#include "input_helpers.hpp"
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <barrier>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <thread>
+
+enum class seat {
+    empty,
+    occupied,
+    floor,
+};
+
+struct seating_area {
+    std::vector<seat> seats;
+    int _width{};
+
+    [[nodiscard]] int width() const { return _width; }
+    [[nodiscard]] int height() const { return static_cast<int>(seats.size()) / _width; }
+
+    [[nodiscard]] bool is_inside(int row, int col) const {
+        return 0 <= row && row < height() && 0 <= col && col < width();
+    }
+
+    [[nodiscard]] seat get(int row, int col) const {
+        if (is_inside(row, col)) {
+            return seats[row*_width + col];
+        } else {
+            return seat::floor;
+        }
+    }
+};
+
+inline std::pair<int, int> index_to_row_col(int index, int width) {
+    return {index % width, index / width};
+}
+
+inline seating_area parse_seats(std::istream& is) {
+    seating_area ret;
+    for (std::string const& line : input_lines(is)) {
+        ret._width = line.length();
+        std::transform(line.begin(), line.end(), std::back_inserter(ret.seats), [](int ch) {
+            if (ch == 'L') {
+                return seat::empty;
+            } else if (ch == '#') {
+                return seat::occupied;
+            } else {
+                return seat::floor;
+            }
+        });
+    }
+    return ret;
+}
+
+inline int occupied_neighbours(seating_area const& seats, int row, int col) {
+    return (seats.get(row-1, col-1) == seat::occupied) +
+           (seats.get(row-1, col  ) == seat::occupied) +
+           (seats.get(row-1, col+1) == seat::occupied) +
+           (seats.get(row  , col-1) == seat::occupied) +
+           (seats.get(row  , col+1) == seat::occupied) +
+           (seats.get(row+1, col-1) == seat::occupied) +
+           (seats.get(row+1, col  ) == seat::occupied) +
+           (seats.get(row+1, col+1) == seat::occupied);
+}
+
+inline bool evolve_close(seating_area const& seats, int row, int col) {
+    if (seats.get(row, col) == seat::empty && occupied_neighbours(seats, row, col) == 0) {
+        return true;
+    } else if (seats.get(row, col) == seat::occupied && occupied_neighbours(seats, row, col) >= 4) {
+        return true;
+    } else {
+        return false;
+    }
+}
+
+inline bool scan_line_of_sight(seating_area const& seats, int row, int col, int drow, int dcol) {
+    do {
+        row += drow;
+        col += dcol;
+        if (seats.get(row, col) == seat::occupied) {
+            return true;
+        } else if (seats.get(row, col) == seat::empty) {
+            return false;
+        }
+    } while (seats.is_inside(row, col));
+    return false;
+}
+
+inline int occupied_line_of_sight(seating_area const& seats, int row, int col) {
+    return (scan_line_of_sight(seats, row, col, -1, -1)) +
+           (scan_line_of_sight(seats, row, col, -1, 0)) +
+           (scan_line_of_sight(seats, row, col, -1, 1)) +
+           (scan_line_of_sight(seats, row, col,  0, -1)) +
+           (scan_line_of_sight(seats, row, col,  0, 1)) +
+           (scan_line_of_sight(seats, row, col,  1, -1)) +
+           (scan_line_of_sight(seats, row, col,  1, 0)) +
+           (scan_line_of_sight(seats, row, col,  1, 1));
+}
+
+inline bool evolve_line_of_sight(seating_area const& seats, int row, int col) {
+    if (seats.get(row, col) == seat::empty && occupied_line_of_sight(seats, row, col) == 0) {
+        return true;
+    } else if (seats.get(row, col) == seat::occupied && occupied_line_of_sight(seats, row, col) >= 5) {
+        return true;
+    } else {
+        return false;
+    }
+}
+
+// For each seat, the indices of the seats that count as its neighbours, eight slots per cell with
+// -1 for an empty slot. The floor never changes, so this is computed once per seating area.
+struct neighbour_table {
+    static constexpr int directions = 8;
+    std::vector<int> neighbours;
+
+    [[nodiscard]] int const* of(int index) const {
+        return &neighbours[index * directions];
+    }
+};
+
+constexpr std::pair<int, int> neighbour_directions[neighbour_table::directions] = {
+        {-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1},
+};
+
+inline neighbour_table adjacent_seats(seating_area const& seats) {
+    neighbour_table table{std::vector<int>(seats.seats.size() * neighbour_table::directions, -1)};
+    for (int row = 0; row < seats.height(); ++row) {
+        for (int col = 0; col < seats.width(); ++col) {
+            for (int d = 0; d < neighbour_table::directions; ++d) {
+                auto const [drow, dcol] = neighbour_directions[d];
+                if (seats.get(row + drow, col + dcol) != seat::floor) {
+                    table.neighbours[(row * seats.width() + col) * neighbour_table::directions + d] = (row + drow) * seats.width() + col + dcol;
+                }
+            }
+        }
+    }
+    return table;
+}
+
+// The first seat visible in each direction. Each direction is one sweep over the area, visiting
+// cells so that the next cell in that direction is already done: it is either a seat itself, or
+// its own first visible seat is the answer.
+inline neighbour_table visible_seats(seating_area const& seats) {
+    int const width = seats.width();
+    int const height = seats.height();
+    neighbour_table table{std::vector<int>(seats.seats.size() * neighbour_table::directions, -1)};
+    for (int d = 0; d < neighbour_table::directions; ++d) {
+        auto const [drow, dcol] = neighbour_directions[d];
+        for (int i = 0; i < height; ++i) {
+            int const row = drow > 0 ? height - 1 - i : i;
+            for (int j = 0; j < width; ++j) {
+                int const col = dcol > 0 ? width - 1 - j : j;
+                int const next_row = row + drow;
+                int const next_col = col + dcol;
+                int& slot = table.neighbours[(row * width + col) * neighbour_table::directions + d];
+                if (!seats.is_inside(next_row, next_col)) {
+                    slot = -1;
+                } else if (seats.get(next_row, next_col) != seat::floor) {
+                    slot = next_row * width + next_col;
+                } else {
+                    slot = table.neighbours[(next_row * width + next_col) * neighbour_table::directions + d];
+                }
+            }
+        }
+    }
+    return table;
+}
+
+// The seat rule over a precomputed neighbour table: an empty seat with no occupied neighbours
+// fills up, and an occupied seat with at least `tolerance` occupied neighbours empties. With
+// adjacent_seats and a tolerance of 4 this is evolve_close; with visible_seats and 5 it is
+// evolve_line_of_sight.
+struct neighbour_rule {
+    neighbour_table const& table;
+    int tolerance;
+
+    bool operator()(seating_area const& seats, int row, int col) const {
+        return at(seats, row * seats.width() + col);
+    }
+
+    [[nodiscard]] bool at(seating_area const& seats, int index) const {
+        seat const s = seats.seats[index];
+        if (s == seat::floor) {
+            return false;
+        }
+        int occupied = 0;
+        int const* const neighbours = table.of(index);
+        for (int d = 0; d < neighbour_table::directions; ++d) {
+            occupied += neighbours[d] >= 0 && seats.seats[neighbours[d]] == seat::occupied;
+        }
+        return s == seat::empty ? occupied == 0 : occupied >= tolerance;
+    }
+};
+
+inline seat evolved(seat const& s) {
+    if (s == seat::empty) {
+        return seat::occupied;
+    } else if (s == seat::occupied) {
+        return seat::empty;
+    } else {
+        return s;
+    }
+}
+
+// Writes rows [row_begin, row_end) of the next generation into `next`, which must have the same
+// size, and returns the number of seats in them that changed.
+template<class Rule>
+size_t evolve_rows(seating_area const& seats, seating_area& next, Rule const& rule, int row_begin, int row_end) {
+    size_t changed = 0;
+    for (int row = row_begin; row < row_end; ++row) {
+        for (int col = 0; col < seats.width(); ++col) {
+            seat const s = seats.seats[row * seats.width() + col];
+            bool const change = rule(seats, row, col);
+            next.seats[row * seats.width() + col] = change ? evolved(s) : s;
+            changed += change;
+        }
+    }
+    return changed;
+}
+
+template<class Rule>
+size_t evolve(seating_area const& seats, seating_area& next, Rule const& rule) {
+    return evolve_rows(seats, next, rule, 0, seats.height());
+}
+
+template<class Rule>
+seating_area evolve_until_stable(seating_area area, Rule const& rule) {
+    seating_area next = area;
+    while (evolve(area, next, rule) != 0) {
+        std::swap(area, next);
+    }
+    return area;
+}
+
+// evolve_until_stable with the rows split into one band per thread. The threads meet at a barrier
+// after each generation, where the per-band change counts are summed to check for a fixed point
+// and the buffers are swapped. Every cell is computed exactly as in the serial version, so the
+// result does not depend on the number of threads.
+template<class Rule>
+seating_area evolve_until_stable_parallel(seating_area area, Rule const& rule, unsigned nr_threads) {
+    int const height = area.height();
+    nr_threads = std::clamp(nr_threads, 1U, static_cast<unsigned>(std::max(height, 1)));
+
+    seating_area next = area;
+    seating_area* current = &area;
+    seating_area* upcoming = &next;
+    std::vector<size_t> changed(nr_threads);
+    bool stable = false;
+    std::barrier sync(nr_threads, [&]() noexcept {
+        stable = std::accumulate(changed.begin(), changed.end(), size_t{0}) == 0;
+        if (!stable) {
+            std::swap(current, upcoming);
+        }
+    });
+
+    auto worker = [&](unsigned thread) {
+        int const row_begin = static_cast<int>(height * thread / nr_threads);
+        int const row_end = static_cast<int>(height * (thread + 1) / nr_threads);
+        while (!stable) {
+            changed[thread] = evolve_rows(*current, *upcoming, rule, row_begin, row_end);
+            sync.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned thread = 1; thread < nr_threads; ++thread) {
+        threads.emplace_back(worker, thread);
+    }
+    worker(0);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    return std::move(*current);
+}
+
+// evolve_until_stable driven by a worklist: only seats with a neighbour that changed in the last
+// generation can change in the next, so only those are re-evaluated. Neighbours are symmetric in
+// both tables, so the worklist is filled from the table entries of the changed seats. It is kept
+// as a bitmap, which removes duplicates and lets it be walked in memory order. Work per
+// generation is proportional to the number of changes, plus one word test per 64 cells.
+inline seating_area evolve_until_stable_worklist(seating_area area, neighbour_table const& table, int tolerance) {
+    neighbour_rule const rule{table, tolerance};
+    std::vector<uint64_t> work((area.seats.size() + 63) / 64);
+    for (size_t index = 0; index < area.seats.size(); ++index) {
+        if (area.seats[index] != seat::floor) {
+            work[index / 64] |= uint64_t{1} << (index % 64);
+        }
+    }
+
+    std::vector<int> changes;
+    bool active = true;
+    while (active) {
+        changes.clear();
+        for (size_t w = 0; w < work.size(); ++w) {
+            for (uint64_t bits = work[w]; bits != 0; bits &= bits - 1) {
+                int const index = static_cast<int>(w * 64 + std::countr_zero(bits));
+                if (rule.at(area, index)) {
+                    changes.push_back(index);
+                }
+            }
+        }
+        for (int index : changes) {
+            area.seats[index] = evolved(area.seats[index]);
+        }
+
+        std::fill(work.begin(), work.end(), 0);
+        for (int index : changes) {
+            int const* const neighbours = table.of(index);
+            for (int d = 0; d < neighbour_table::directions; ++d) {
+                int const n = neighbours[d];
+                if (n >= 0) {
+                    work[n / 64] |= uint64_t{1} << (n % 64);
+                }
+            }
+        }
+        active = !changes.empty();
+    }
+    return area;
+}
+
+// The seat automaton on bit planes: one bit per cell for "is a seat" and one for "is occupied",
+// packed 64 cells to a word with each row padded to whole words. A generation builds, for each of
+// the eight directions, the plane of "the neighbour in this direction is occupied", adds the eight
+// planes with bitwise ripple adders into a 4-bit count per cell, and applies the thresholds, all
+// 64 cells at a time.
+//
+// For line of sight, a direction plane is a fill across the floor by doubling: with v_k the
+// occupancy of the nearest seat within k steps, and f_k whether the first k steps are all floor,
+// v_2k = v_k | (f_k & v_k shifted k steps), and f_2k = f_k & f_k shifted k steps. The floor is
+// fixed, so the f_k planes are computed once.
+class bitsliced_seats {
+public:
+    bitsliced_seats(seating_area const& area, bool line_of_sight, int tolerance)
+            : _rows(area.height())
+            , _cols(area.width())
+            , _words((area.width() + 63) / 64)
+            , _tolerance(tolerance)
+            , _seats(plane_size())
+            , _occupied(plane_size())
+            , _count_bits{plane(plane_size()), plane(plane_size()), plane(plane_size()), plane(plane_size())}
+            , _visible(plane_size())
+            , _further(plane_size())
+    {
+        for (int row = 0; row < _rows; ++row) {
+            for (int col = 0; col < _cols; ++col) {
+                seat const s = area.get(row, col);
+                set(_seats, row, col, s != seat::floor);
+                set(_occupied, row, col, s == seat::occupied);
+            }
+        }
+
+        plane floor(plane_size());
+        for (int row = 0; row < _rows; ++row) {
+            for (int w = 0; w < _words; ++w) {
+                floor[row * _words + w] = ~_seats[row * _words + w] & valid_bits(w);
+            }
+        }
+        for (int d = 0; d < neighbour_table::directions; ++d) {
+            if (!line_of_sight) {
+                continue;
+            }
+            auto const [drow, dcol] = neighbour_directions[d];
+            plane f = shifted(floor, drow, dcol);
+            for (int k = 1; k < std::max(_rows, _cols); k *= 2) {
+                _floor_runs[d].push_back(f);
+                f = and_planes(f, shifted(f, drow * k, dcol * k));
+            }
+        }
+    }
+
+    // Advances one generation and returns the number of seats that changed.
+    size_t step() {
+        auto& [c0, c1, c2, c3] = _count_bits;
+        for (plane& c : _count_bits) {
+            std::fill(c.begin(), c.end(), 0);
+        }
+        for (int d = 0; d < neighbour_table::directions; ++d) {
+            auto const [drow, dcol] = neighbour_directions[d];
+            plane& v = _visible;
+            shift_into(_occupied, v, drow, dcol);
+            int k = 1;
+            for (plane const& f : _floor_runs[d]) {
+                shift_into(v, _further, drow * k, dcol * k);
+                for (size_t i = 0; i < v.size(); ++i) {
+                    v[i] |= f[i] & _further[i];
+                }
+                k *= 2;
+            }
+            for (size_t i = 0; i < v.size(); ++i) {
+                uint64_t const carry0 = c0[i] & v[i];
+                c0[i] ^= v[i];
+                uint64_t const carry1 = c1[i] & carry0;
+                c1[i] ^= carry0;
+                uint64_t const carry2 = c2[i] & carry1;
+                c2[i] ^= carry1;
+                c3[i] |= carry2;
+            }
+        }
+
+        size_t changed = 0;
+        for (size_t i = 0; i < _occupied.size(); ++i) {
+            uint64_t const counts[4] = {c0[i], c1[i], c2[i], c3[i]};
+            // count >= tolerance, compared bit by bit from the top.
+            uint64_t at_least = 0;
+            uint64_t equal = ~uint64_t{0};
+            for (int bit = 3; bit >= 0; --bit) {
+                if (_tolerance & (1 << bit)) {
+                    equal &= counts[bit];
+                } else {
+                    at_least |= equal & counts[bit];
+                    equal &= ~counts[bit];
+                }
+            }
+            at_least |= equal;
+            uint64_t const none = ~(c0[i] | c1[i] | c2[i] | c3[i]);
+
+            uint64_t const occupied = _occupied[i];
+            uint64_t const next = (occupied & ~at_least) | (_seats[i] & ~occupied & none);
+            changed += std::popcount(next ^ occupied);
+            _occupied[i] = next;
+        }
+        return changed;
+    }
+
+    [[nodiscard]] seating_area area() const {
+        seating_area ret{std::vector<seat>(static_cast<size_t>(_rows) * _cols), _cols};
+        for (int row = 0; row < _rows; ++row) {
+            for (int col = 0; col < _cols; ++col) {
+                ret.seats[row * _cols + col] =
+                        !get(_seats, row, col) ? seat::floor :
+                        get(_occupied, row, col) ? seat::occupied :
+                        seat::empty;
+            }
+        }
+        return ret;
+    }
+
+private:
+    using plane = std::vector<uint64_t>;
+
+    [[nodiscard]] size_t plane_size() const {
+        return static_cast<size_t>(_rows) * _words;
+    }
+
+    [[nodiscard]] uint64_t valid_bits(int word) const {
+        int const bits = std::min(64, _cols - word * 64);
+        return bits == 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+    }
+
+    void set(plane& p, int row, int col, bool value) const {
+        uint64_t const bit = uint64_t{1} << (col % 64);
+        uint64_t& word = p[row * _words + col / 64];
+        word = value ? word | bit : word & ~bit;
+    }
+
+    [[nodiscard]] bool get(plane const& p, int row, int col) const {
+        return (p[row * _words + col / 64] >> (col % 64)) & 1;
+    }
+
+    static plane and_planes(plane a, plane const& b) {
+        for (size_t i = 0; i < a.size(); ++i) {
+            a[i] &= b[i];
+        }
+        return a;
+    }
+
+    // out(row, col) = in(row + drow, col + dcol), or 0 outside the area. `out` must already have
+    // the size of a plane and must not be `in`.
+    void shift_into(plane const& in, plane& out, int drow, int dcol) const {
+        int const q = std::abs(dcol) / 64;
+        int const b = std::abs(dcol) % 64;
+        for (int row = 0; row < _rows; ++row) {
+            int const src_row = row + drow;
+            uint64_t* const dst = &out[row * _words];
+            if (src_row < 0 || src_row >= _rows) {
+                std::fill(dst, dst + _words, 0);
+                continue;
+            }
+            uint64_t const* const src = &in[src_row * _words];
+            auto word = [&](int w) {
+                return 0 <= w && w < _words ? src[w] : 0;
+            };
+            for (int w = 0; w < _words; ++w) {
+                if (dcol >= 0) {
+                    dst[w] = (word(w + q) >> b) | (b != 0 ? word(w + q + 1) << (64 - b) : 0);
+                } else {
+                    dst[w] = (word(w - q) << b) | (b != 0 ? word(w - q - 1) >> (64 - b) : 0);
+                }
+            }
+            dst[_words - 1] &= valid_bits(_words - 1);
+        }
+    }
+
+    [[nodiscard]] plane shifted(plane const& in, int drow, int dcol) const {
+        plane out(in.size());
+        shift_into(in, out, drow, dcol);
+        return out;
+    }
+
+    int _rows;
+    int _cols;
+    int _words;
+    int _tolerance;
+    plane _seats;
+    plane _occupied;
+    std::vector<plane> _floor_runs[neighbour_table::directions];
+    // Scratch planes for step(), allocated once: the 4-bit neighbour counts, the direction plane
+    // being built, and its shifted copy.
+    plane _count_bits[4];
+    plane _visible;
+    plane _further;
+};
+
+inline seating_area evolve_until_stable_bitsliced(seating_area const& area, bool line_of_sight, int tolerance) {
+    bitsliced_seats seats(area, line_of_sight, tolerance);
+    while (seats.step() != 0) {
+    }
+    return seats.area();
+}
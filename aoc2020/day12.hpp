@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum turn {
+    left,
+    right,
+};
+
+struct action {
+    int instruction = 'F';
+    int amount = 0;
+};
+
+inline action parse_action(std::string const& line) {
+    if (!line.empty()) {
+        return {line.front(), atoi(line.substr(1).c_str())};
+    } else {
+        return {};
+    }
+}
+
+struct vec2 {
+    long x = 0;
+    long y = 0;
+};
+
+struct mat2 {
+    long xx = 1;
+    long xy = 0;
+    long yx = 0;
+    long yy = 1;
+};
+
+inline vec2 operator+(vec2 a, vec2 b) {
+    return {a.x + b.x, a.y + b.y};
+}
+
+inline vec2 operator*(mat2 const& m, vec2 v) {
+    return {m.xx * v.x + m.xy * v.y, m.yx * v.x + m.yy * v.y};
+}
+
+inline mat2 operator*(mat2 const& a, mat2 const& b) {
+    return {a.xx * b.xx + a.xy * b.yx, a.xx * b.xy + a.xy * b.yy,
+            a.yx * b.xx + a.yy * b.yx, a.yx * b.xy + a.yy * b.yy};
+}
+
+inline mat2 operator+(mat2 const& a, mat2 const& b) {
+    return {a.xx + b.xx, a.xy + b.xy, a.yx + b.yx, a.yy + b.yy};
+}
+
+// The ship and the vector it moves along: its facing for the first set of rules, the waypoint for
+// the second.
+struct nav_state {
+    vec2 ship;
+    vec2 vector;
+};
+
+// Every action is an affine map on the navigation state:
+//   ship' = ship + ship_from_vector * vector + ship_offset
+//   vector' = rotate * vector + vector_offset
+// These compose associatively, so a log of actions can be folded in any grouping.
+struct navigation {
+    mat2 rotate{};
+    mat2 ship_from_vector{0, 0, 0, 0};
+    vec2 ship_offset{};
+    vec2 vector_offset{};
+};
+
+inline nav_state apply(navigation const& n, nav_state const& s) {
+    return {s.ship + n.ship_from_vector * s.vector + n.ship_offset, n.rotate * s.vector + n.vector_offset};
+}
+
+// The navigation that applies `first` and then `second`.
+inline navigation then(navigation const& first, navigation const& second) {
+    return {
+            second.rotate * first.rotate,
+            first.ship_from_vector + second.ship_from_vector * first.rotate,
+            first.ship_offset + second.ship_from_vector * first.vector_offset + second.ship_offset,
+            second.rotate * first.vector_offset + second.vector_offset,
+    };
+}
+
+inline mat2 rotation(turn t, int amount) {
+    mat2 const quarter = t == turn::left ? mat2{0, -1, 1, 0} : mat2{0, 1, -1, 0};
+    if (amount == 90) {
+        return quarter;
+    } else if (amount == 180) {
+        return quarter * quarter;
+    } else if (amount == 270) {
+        return quarter * quarter * quarter;
+    } else {
+        return {};
+    }
+}
+
+enum class rules {
+    facing,
+    waypoint,
+};
+
+inline navigation compile(action action, rules rules) {
+    navigation n;
+    vec2 const step =
+            action.instruction == 'N' ? vec2{0, action.amount} :
+            action.instruction == 'S' ? vec2{0, -action.amount} :
+            action.instruction == 'E' ? vec2{action.amount, 0} :
+            action.instruction == 'W' ? vec2{-action.amount, 0} :
+            vec2{};
+    (rules == rules::facing ? n.ship_offset : n.vector_offset) = step;
+    if (action.instruction == 'F') {
+        n.ship_from_vector = {action.amount, 0, 0, action.amount};
+    } else if (action.instruction == 'L') {
+        n.rotate = rotation(turn::left, action.amount);
+    } else if (action.instruction == 'R') {
+        n.rotate = rotation(turn::right, action.amount);
+    }
+    return n;
+}
+
+// Folds a chunk of actions into a single navigation.
+inline navigation compile_range(std::vector<action> const& actions, size_t begin, size_t end, rules rules) {
+    navigation total;
+    for (size_t i = begin; i < end; ++i) {
+        total = then(total, compile(actions[i], rules));
+    }
+    return total;
+}
+
+// The state after every action, computed as a parallel prefix scan: each thread folds one chunk,
+// the chunk totals are scanned serially, and then each thread replays its chunk from the state
+// at its start. If `states` is null only the final state is computed.
+inline nav_state navigate(std::vector<action> const& actions, rules rules, nav_state initial, unsigned nr_threads, std::vector<nav_state>* states = nullptr) {
+    nr_threads = std::clamp<unsigned>(nr_threads, 1, std::max<size_t>(actions.size(), 1));
+    auto chunk_begin = [&](unsigned chunk) {
+        return actions.size() * chunk / nr_threads;
+    };
+    auto parallel = [&](auto fn) {
+        std::vector<std::thread> threads;
+        for (unsigned chunk = 1; chunk < nr_threads; ++chunk) {
+            threads.emplace_back(fn, chunk);
+        }
+        fn(0);
+        for (std::thread& t : threads) {
+            t.join();
+        }
+    };
+
+    std::vector<navigation> chunk_totals(nr_threads);
+    parallel([&](unsigned chunk) {
+        chunk_totals[chunk] = compile_range(actions, chunk_begin(chunk), chunk_begin(chunk + 1), rules);
+    });
+
+    std::vector<nav_state> chunk_starts(nr_threads + 1, initial);
+    for (unsigned chunk = 0; chunk < nr_threads; ++chunk) {
+        chunk_starts[chunk + 1] = apply(chunk_totals[chunk], chunk_starts[chunk]);
+    }
+
+    if (states != nullptr) {
+        states->resize(actions.size());
+        parallel([&](unsigned chunk) {
+            nav_state state = chunk_starts[chunk];
+            for (size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+                state = apply(compile(actions[i], rules), state);
+                (*states)[i] = state;
+            }
+        });
+    }
+    return chunk_starts.back();
+}
@@ -5,6 +5,9 @@
 #include <regex>
 #include <iterator>
 #include <algorithm>
+#include <limits>
+#include <optional>
+#include <string>
 
 
 constexpr long x = -1;
@@ -54,17 +57,15 @@ long earliest_departure_bus(long start_time, std::vector<long> const& buses) {
     }
 }
 
-long find_bus_alignment(std::vector<long> const& buses) {
-    std::vector<long> remainders;
-    std::vector<long> moduli;
+std::optional<big_unsigned> find_bus_alignment(std::vector<long> const& buses) {
+    std::vector<congruence> congruences;
     for (size_t i = 0; i < buses.size(); ++i) {
         long const bus = buses[i];
         if (bus != x) {
-            remainders.push_back(bus - i);
-            moduli.push_back(bus);
+            congruences.push_back({bus - static_cast<long>(i % bus), bus});
         }
     }
-    return chinese_remainder(remainders, moduli);
+    return solve_congruences(congruences);
 }
 
 void run() {
@@ -73,5 +74,9 @@ void run() {
     long const earliest_bus = earliest_departure_bus(input.start_time, input.buses);
     std::cout << (earliest_bus * (earliest_bus_time(input.start_time, earliest_bus) - input.start_time)) << std::endl;
 
-    std::cout << find_bus_alignment(input.buses) << std::endl;
+    if (auto const alignment = find_bus_alignment(input.buses)) {
+        std::cout << *alignment << std::endl;
+    } else {
+        std::cout << "No alignment!" << std::endl;
+    }
 }
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <bit>
+#include <numeric>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class oper {
+    mask,
+    mem,
+};
+
+struct instr {
+    oper op;
+    unsigned long arg1;
+    unsigned long arg2;
+
+    static instr mask(unsigned long use, unsigned long override) {
+        return instr{oper::mask, use, override};
+    }
+
+    static instr mem(unsigned long dest, unsigned long value) {
+        return instr{oper::mem, dest, value};
+    }
+};
+
+struct mask {
+    unsigned long use;
+    unsigned long override;
+};
+
+inline mask split_mask(std::string const& mask_str) {
+    unsigned long use = 0;
+    unsigned long override = 0;
+    for (char ch : mask_str) {
+        use <<= 1;
+        override <<= 1;
+        if (ch == '0') {
+            use |= 1;
+            override |= 0;
+        } else if (ch == '1') {
+            use |= 1;
+            override |= 1;
+        }
+    }
+    return {use, override};
+}
+
+inline instr parse_instr(std::string const& line) {
+    static std::regex const mask_pattern(R"(mask = ([10X]+))");
+    static std::regex const mem_pattern(R"(mem\[([0-9]+)\] = ([0-9]+))");
+    std::smatch m;
+    if (std::regex_match(line, m, mask_pattern)) {
+        mask mask = split_mask(m[1].str());
+        return instr::mask(mask.use, mask.override);
+    } else if(std::regex_match(line, m, mem_pattern)) {
+        unsigned long dest = atol(m[1].str().c_str());
+        unsigned long value = atol(m[2].str().c_str());
+        return instr::mem(dest, value);
+    } else {
+        return {};
+    }
+}
+
+inline void apply(instr const& instr, std::unordered_map<unsigned long, unsigned long>& memory, mask& current_mask) {
+    if (instr.op == oper::mask) {
+        current_mask.use = instr.arg1;
+        current_mask.override = instr.arg2;
+    } else {
+        memory[instr.arg1] = (instr.arg2 & ~current_mask.use) | (current_mask.override & current_mask.use);
+    }
+}
+
+constexpr unsigned long address_bits = (1UL << 36) - 1;
+
+// A set of addresses: the bits in `floating` take every value, the others are given by `fixed`.
+struct address_pattern {
+    unsigned long fixed;
+    unsigned long floating;
+
+    [[nodiscard]] unsigned long size() const {
+        return 1UL << std::popcount(floating);
+    }
+
+    [[nodiscard]] bool overlaps(address_pattern const& other) const {
+        unsigned long const both_fixed = ~floating & ~other.floating & address_bits;
+        return (fixed & both_fixed) == (other.fixed & both_fixed);
+    }
+};
+
+// Splits `from` minus `removed` into disjoint patterns and calls emit(pattern) for each: for every
+// bit that floats in `from` but is fixed in `removed`, the half that disagrees with `removed` is
+// kept and the search continues in the half that agrees. That gives at most one pattern per such
+// bit, none if `removed` covers `from`, and `from` itself if the two do not overlap.
+template<class F>
+void subtract_pattern(address_pattern from, address_pattern const& removed, F emit) {
+    if (!from.overlaps(removed)) {
+        emit(from);
+        return;
+    }
+    unsigned long split = from.floating & ~removed.floating;
+    while (split != 0) {
+        unsigned long const bit = split & -split;
+        split &= split - 1;
+        from.floating &= ~bit;
+        emit(address_pattern{from.fixed | (~removed.fixed & bit), from.floating});
+        from.fixed |= removed.fixed & bit;
+    }
+}
+
+// Memory where each write covers a whole address pattern. The live patterns are kept disjoint:
+// a write carves its addresses out of every earlier pattern it overlaps, so the sum of memory is
+// a sum over patterns and never depends on 2^X directly. A write costs O(live patterns), and
+// each overlapping live pattern can split into up to 36 fragments. On typical inputs the live
+// patterns stay close to the number of writes, but writes that fix different bits of one wide
+// pattern multiply its fragments (an all-X write followed by writes fixing disjoint 4-bit groups
+// grows them fourfold per write). A bound in the number of writes alone is not to be expected:
+// counting the addresses in a union of patterns is counting the solutions of a DNF formula.
+class floating_memory {
+public:
+    void write(address_pattern const& pattern, unsigned long value) {
+        std::vector<std::pair<address_pattern, unsigned long>> next;
+        next.reserve(_writes.size() + 1);
+        for (auto const& [live, live_value] : _writes) {
+            subtract_pattern(live, pattern, [&, value = live_value](address_pattern const& p) {
+                next.emplace_back(p, value);
+            });
+        }
+        next.emplace_back(pattern, value);
+        _writes = std::move(next);
+    }
+
+    [[nodiscard]] unsigned long sum() const {
+        return std::accumulate(_writes.begin(), _writes.end(), 0UL, [](unsigned long sum, auto const& w) {
+            return sum + w.first.size() * w.second;
+        });
+    }
+
+    [[nodiscard]] size_t nr_patterns() const {
+        return _writes.size();
+    }
+
+private:
+    std::vector<std::pair<address_pattern, unsigned long>> _writes;
+};
+
+inline void apply_version2(instr const& instr, floating_memory& memory, mask& current_mask) {
+    if (instr.op == oper::mask) {
+        current_mask.use = instr.arg1;
+        current_mask.override = instr.arg2;
+    } else {
+        unsigned long const base_address = (instr.arg1 & current_mask.use) | current_mask.override;
+        memory.write({base_address, ~current_mask.use & address_bits}, instr.arg2);
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+inline std::vector<int> parse_numbers(std::istream& is) {
+    return std::vector<int>(std::istream_iterator<int>{is}, std::istream_iterator<int>{});
+}
+
+// Last-seen turns for every number in one flat array, with 0 for never.
+class dense_last_seen {
+public:
+    explicit dense_last_seen(size_t nr_numbers)
+            : _turns(nr_numbers, 0)
+    {}
+
+    // Records that `number` is spoken on `turn` and returns the turn it was last spoken on before.
+    uint32_t exchange(uint32_t number, uint32_t turn) {
+        uint32_t& slot = _turns[number];
+        uint32_t const previous = slot;
+        slot = turn;
+        return previous;
+    }
+
+    [[nodiscard]] size_t memory_bytes() const {
+        return _turns.size() * sizeof(uint32_t);
+    }
+
+private:
+    std::vector<uint32_t> _turns;
+};
+
+// Last-seen turns in two tiers: small numbers, which get nearly all the hits, in a dense array,
+// and the rare large ones in an open-addressed table with linear probing. The dense tier takes
+// half of the memory limit (or less, if that covers every number) and the table may grow into
+// the rest; growing beyond the limit throws std::length_error.
+class tiered_last_seen {
+public:
+    tiered_last_seen(size_t nr_numbers, size_t memory_limit)
+            : _dense(std::min(nr_numbers, memory_limit / 2 / sizeof(uint32_t)), 0)
+            , _table_limit(memory_limit - _dense.size() * sizeof(uint32_t))
+    {
+        if (_dense.size() < nr_numbers) {
+            rehash(1024);
+        }
+    }
+
+    uint32_t exchange(uint32_t number, uint32_t turn) {
+        if (number < _dense.size()) {
+            uint32_t& slot = _dense[number];
+            uint32_t const previous = slot;
+            slot = turn;
+            return previous;
+        }
+        size_t i = find(number);
+        if (_keys[i] == number) {
+            uint32_t const previous = _values[i];
+            _values[i] = turn;
+            return previous;
+        }
+        if (2 * (_size + 1) > _keys.size()) {
+            rehash(2 * _keys.size());
+            i = find(number);
+        }
+        _keys[i] = number;
+        _values[i] = turn;
+        ++_size;
+        return 0;
+    }
+
+    [[nodiscard]] size_t memory_bytes() const {
+        return (_dense.size() + _keys.size() + _values.size()) * sizeof(uint32_t);
+    }
+
+private:
+    static constexpr uint32_t empty = -1;
+
+    [[nodiscard]] size_t find(uint32_t number) const {
+        size_t const mask = _keys.size() - 1;
+        size_t i = (number * 0x9E3779B97F4A7C15UL) >> _shift;
+        while (_keys[i] != number && _keys[i] != empty) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void rehash(size_t capacity) {
+        if (2 * capacity * sizeof(uint32_t) > _table_limit) {
+            throw std::length_error("tiered_last_seen: memory limit exceeded");
+        }
+        std::vector<uint32_t> keys(capacity, empty);
+        std::vector<uint32_t> values(capacity);
+        std::swap(keys, _keys);
+        std::swap(values, _values);
+        _shift = 64 - std::countr_zero(capacity);
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (keys[i] != empty) {
+                size_t const j = find(keys[i]);
+                _keys[j] = keys[i];
+                _values[j] = values[i];
+            }
+        }
+    }
+
+    std::vector<uint32_t> _dense;
+    size_t _table_limit;
+    std::vector<uint32_t> _keys;
+    std::vector<uint32_t> _values;
+    size_t _size = 0;
+    int _shift = 64;
+};
+
+// Every number spoken is below the turn count or among the starting numbers.
+inline size_t memory_game_numbers(std::vector<int> const& starting_numbers, uint32_t nr_turns) {
+    int const max_start = starting_numbers.empty() ? 0 : *std::max_element(starting_numbers.begin(), starting_numbers.end());
+    return std::max<size_t>(nr_turns, max_start + 1);
+}
+
+// Plays the memory game until turn `nr_turns` and returns the number spoken on each of the
+// (1-based, ascending, at most nr_turns) checkpoint turns; other checkpoints throw std::invalid_argument.
+// `last_seen` maps numbers to the turn they were last spoken on, so each turn is a single
+// exchange on it.
+template<class LastSeen>
+std::vector<uint32_t> play_memory_game(std::vector<int> const& starting_numbers, uint32_t nr_turns,
+                                       std::vector<uint32_t> const& checkpoints, LastSeen& last_seen) {
+    if (!checkpoints.empty() && (checkpoints.front() == 0 || checkpoints.back() > nr_turns
+                                 || !std::ranges::is_sorted(checkpoints))) {
+        throw std::invalid_argument("play_memory_game: checkpoints must be ascending turns from 1 to nr_turns");
+    }
+    std::vector<uint32_t> spoken;
+    if (starting_numbers.empty()) {
+        return spoken;
+    }
+    uint32_t const nr_start = starting_numbers.size();
+    for (uint32_t turn = 1; turn < nr_start; ++turn) {
+        last_seen.exchange(starting_numbers[turn - 1], turn);
+    }
+
+    uint32_t current = starting_numbers.back();
+    uint32_t turn = nr_start;
+    for (uint32_t const checkpoint : checkpoints) {
+        if (checkpoint <= nr_start) {
+            spoken.push_back(starting_numbers[checkpoint - 1]);
+            continue;
+        }
+        for (; turn < checkpoint; ++turn) {
+            uint32_t const previous = last_seen.exchange(current, turn);
+            current = previous != 0 ? turn - previous : 0;
+        }
+        spoken.push_back(current);
+    }
+    return spoken;
+}
+
+inline std::vector<uint32_t> play_memory_game(std::vector<int> const& starting_numbers, uint32_t nr_turns,
+                                              std::vector<uint32_t> const& checkpoints) {
+    dense_last_seen last_seen(memory_game_numbers(starting_numbers, nr_turns));
+    return play_memory_game(starting_numbers, nr_turns, checkpoints, last_seen);
+}
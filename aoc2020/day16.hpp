@@ -0,0 +1,387 @@
+#pragma once
+
+#include "range_helpers.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <thread>
+#include <string>
+#include <vector>
+#include <regex>
+#include <sstream>
+
+struct range_t {
+    int low = 0;
+    int high = 0;
+};
+
+using constraint_t = std::pair<range_t, range_t>;
+
+struct field_t {
+    std::string name;
+    constraint_t constraint;
+};
+
+// Fields in input order; a field's id is its index.
+using constraints_t = std::vector<field_t>;
+
+using ticket_t = std::vector<int>;
+
+struct problem_t {
+    constraints_t constraints;
+    ticket_t your_ticket;
+    std::vector<ticket_t> nearby_tickets;
+};
+
+inline ticket_t parse_ticket(std::string const& line) {
+    std::istringstream is(line);
+    ticket_t ret;
+
+    int tmp{};
+    while (is >> tmp) {
+        ret.push_back(tmp);
+        if (is.get() != ',' && is) {
+            std::cout << "Unexpected input while parsing ticket: " << line << std::endl;
+        }
+    }
+    return ret;
+}
+
+inline problem_t parse_problem(std::istream& is) {
+    static const std::regex constraint_pattern(R"((.*): ([0-9]+)-([0-9]+) or ([0-9]+)-([0-9]+))");
+    std::string line;
+    constraints_t constraints;
+    auto to_int = [](std::string const& s) {
+        return std::atoi(s.c_str());
+    };
+    while (std::getline(is, line) && !line.empty()) {
+        std::smatch m;
+        if (std::regex_match(line, m, constraint_pattern)) {
+            constraints.push_back({m[1].str(), {
+                    {to_int(m[2].str()), to_int(m[3].str())},
+                    {to_int(m[4].str()), to_int(m[5].str())}
+            }});
+        } else {
+            std::cout << "Failed to parse: " << line << std::endl;
+        }
+    }
+
+    ticket_t your_ticket;
+    line = {};
+    if (std::getline(is, line) && line == "your ticket:") {
+        std::getline(is, line);
+        your_ticket = parse_ticket(line);
+    } else {
+        std::cout << "Expected your ticket, got " << line << std::endl;
+    }
+
+    if (!std::getline(is, line) || !line.empty()) {
+        std::cout << "Expected empty line, got " << line << std::endl;
+    }
+
+    std::vector<ticket_t> nearby_tickets;
+    line = {};
+    if (std::getline(is, line) && line == "nearby tickets:") {
+        while (std::getline(is, line)) {
+            nearby_tickets.push_back(parse_ticket(line));
+        }
+    } else {
+        std::cout << "Expected nearby tickets, got " << line << std::endl;
+    }
+
+    if (std::getline(is, line)) {
+        std::cout << "Something went wrong before the end of input: " << line << std::endl;
+    }
+
+    return {std::move(constraints), std::move(your_ticket), std::move(nearby_tickets)};
+}
+
+// For every value, the set of fields it satisfies as a bitmask of `words` 64-bit words, plus
+// whether it satisfies any field at all. Values outside the table, including negative ones, are
+// clamped onto a final all-zero row.
+class field_lut {
+public:
+    explicit field_lut(constraints_t const& constraints)
+            : _nr_fields(constraints.size())
+            , _words(std::max<size_t>((constraints.size() + 63) / 64, 1))
+    {
+        int max_value = 0;
+        for (auto const& field : constraints) {
+            max_value = std::max({max_value, field.constraint.first.high, field.constraint.second.high});
+        }
+        _size = max_value + 2;
+        _masks.assign(_size * _words, 0);
+        _any.assign(_size, 0);
+        for (size_t id = 0; id < constraints.size(); ++id) {
+            for (range_t const& range : {constraints[id].constraint.first, constraints[id].constraint.second}) {
+                for (int value = std::max(range.low, 0); value <= range.high; ++value) {
+                    _masks[value * _words + id / 64] |= uint64_t{1} << (id % 64);
+                    _any[value] = 1;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] size_t words() const {
+        return _words;
+    }
+
+    // Word w of the mask with every field set.
+    [[nodiscard]] uint64_t all_fields(size_t w) const {
+        size_t const bits = std::min<size_t>(_nr_fields - std::min(_nr_fields, w * 64), 64);
+        return bits == 64 ? ~uint64_t{0} : (uint64_t{1} << bits) - 1;
+    }
+
+    [[nodiscard]] size_t index(int value) const {
+        return std::min<size_t>(static_cast<unsigned>(value), _size - 1);
+    }
+
+    [[nodiscard]] uint64_t const* mask(int value) const {
+        return &_masks[index(value) * _words];
+    }
+
+    [[nodiscard]] bool any(int value) const {
+        return _any[index(value)];
+    }
+
+private:
+    size_t _nr_fields;
+    size_t _words;
+    size_t _size{};
+    std::vector<uint64_t> _masks;
+    std::vector<uint8_t> _any;
+};
+
+inline int validate_ticket(ticket_t const& ticket, field_lut const& lut) {
+    int invalid_sum = 0;
+    for (int field : ticket) {
+        if (!lut.any(field)) {
+            invalid_sum += field;
+        }
+    }
+    return invalid_sum;
+}
+
+inline int ticket_scanning_error_rate(std::vector<ticket_t> const& tickets, field_lut const& lut) {
+    return tickets | std::views::transform([&](ticket_t const& t) { return validate_ticket(t, lut); }) | accumulate(0);
+}
+
+// Tickets stored column-major: value `column` of ticket `t` is values[column * nr_tickets + t].
+// Only tickets with the expected number of columns are kept.
+struct ticket_columns {
+    size_t nr_columns{};
+    size_t nr_tickets{};
+    std::vector<int> values;
+
+    ticket_columns(std::vector<ticket_t> const& tickets, size_t nr_columns)
+            : nr_columns(nr_columns)
+    {
+        std::vector<ticket_t const*> kept;
+        for (ticket_t const& ticket : tickets) {
+            if (ticket.size() == nr_columns) {
+                kept.push_back(&ticket);
+            }
+        }
+        nr_tickets = kept.size();
+        values.resize(nr_columns * nr_tickets);
+        for (size_t t = 0; t < nr_tickets; ++t) {
+            for (size_t column = 0; column < nr_columns; ++column) {
+                values[column * nr_tickets + t] = (*kept[t])[column];
+            }
+        }
+    }
+
+    [[nodiscard]] int const* column(size_t c) const {
+        return &values[c * nr_tickets];
+    }
+};
+
+// The fields each column can be, as bitmasks of lut.words() words per column: the AND over all
+// valid tickets of the fields each value satisfies. Tickets are split into one chunk per thread;
+// each chunk first finds its valid tickets and then AND-reduces every column, and the chunk
+// results are ANDed together at the end.
+inline std::vector<uint64_t> candidate_fields(ticket_columns const& tickets, field_lut const& lut, unsigned nr_threads) {
+    size_t const words = lut.words();
+    nr_threads = std::clamp<unsigned>(nr_threads, 1, std::max<size_t>(tickets.nr_tickets, 1));
+    // Without any valid ticket a column can be every field, but no more.
+    std::vector<uint64_t> all(tickets.nr_columns * words);
+    for (size_t i = 0; i < all.size(); ++i) {
+        all[i] = lut.all_fields(i % words);
+    }
+    std::vector<std::vector<uint64_t>> partial(nr_threads, all);
+
+    auto reduce_chunk = [&](unsigned chunk) {
+        size_t const begin = tickets.nr_tickets * chunk / nr_threads;
+        size_t const end = tickets.nr_tickets * (chunk + 1) / nr_threads;
+        std::vector<uint8_t> valid(end - begin, 1);
+        for (size_t c = 0; c < tickets.nr_columns; ++c) {
+            int const* const column = tickets.column(c);
+            for (size_t t = begin; t < end; ++t) {
+                valid[t - begin] &= lut.any(column[t]);
+            }
+        }
+        for (size_t c = 0; c < tickets.nr_columns; ++c) {
+            int const* const column = tickets.column(c);
+            uint64_t* const acc = &partial[chunk][c * words];
+            for (size_t t = begin; t < end; ++t) {
+                uint64_t const keep = valid[t - begin] ? 0 : ~uint64_t{0};
+                uint64_t const* const mask = lut.mask(column[t]);
+                for (size_t w = 0; w < words; ++w) {
+                    acc[w] &= mask[w] | keep;
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned chunk = 1; chunk < nr_threads; ++chunk) {
+        threads.emplace_back(reduce_chunk, chunk);
+    }
+    reduce_chunk(0);
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    for (unsigned chunk = 1; chunk < nr_threads; ++chunk) {
+        for (size_t i = 0; i < partial[0].size(); ++i) {
+            partial[0][i] &= partial[chunk][i];
+        }
+    }
+    return std::move(partial[0]);
+}
+
+// Matches columns to distinct fields along the candidate bitsets (`words` words per column) with
+// Hopcroft-Karp. `field_of` and `column_of` may hold a partial matching already, which is kept and
+// extended. Returns false if some column cannot be matched.
+inline bool match_fields(std::vector<uint64_t> const& candidates, size_t words,
+                  std::vector<int>& field_of, std::vector<int>& column_of) {
+    size_t const nr_columns = field_of.size();
+    constexpr int unreachable = std::numeric_limits<int>::max();
+    std::vector<int> dist(nr_columns);
+
+    auto for_each_field = [&](size_t column, auto fn) {
+        for (size_t w = 0; w < words; ++w) {
+            for (uint64_t bits = candidates[column * words + w]; bits != 0; bits &= bits - 1) {
+                if (fn(static_cast<int>(w * 64 + std::countr_zero(bits)))) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    // Layers free columns at distance 0 and alternates along matched edges; true if some
+    // augmenting path reaches a free field.
+    auto bfs = [&] {
+        std::vector<size_t> queue;
+        for (size_t column = 0; column < nr_columns; ++column) {
+            dist[column] = field_of[column] < 0 ? 0 : unreachable;
+            if (field_of[column] < 0) {
+                queue.push_back(column);
+            }
+        }
+        bool found = false;
+        for (size_t i = 0; i < queue.size(); ++i) {
+            size_t const column = queue[i];
+            for_each_field(column, [&](int field) {
+                int const next = column_of[field];
+                if (next < 0) {
+                    found = true;
+                } else if (dist[next] == unreachable) {
+                    dist[next] = dist[column] + 1;
+                    queue.push_back(next);
+                }
+                return false;
+            });
+        }
+        return found;
+    };
+
+    auto dfs = [&](auto& self, size_t column) -> bool {
+        bool const augmented = for_each_field(column, [&](int field) {
+            int const next = column_of[field];
+            if (next < 0 || (dist[next] == dist[column] + 1 && self(self, next))) {
+                field_of[column] = field;
+                column_of[field] = static_cast<int>(column);
+                return true;
+            }
+            return false;
+        });
+        if (!augmented) {
+            dist[column] = unreachable;
+        }
+        return augmented;
+    };
+
+    while (bfs()) {
+        for (size_t column = 0; column < nr_columns; ++column) {
+            if (field_of[column] < 0) {
+                dfs(dfs, column);
+            }
+        }
+    }
+    return std::ranges::none_of(field_of, [](int field) { return field < 0; });
+}
+
+// Assigns a distinct field id to every column. Columns with a single candidate are settled first,
+// and their field is removed from the other columns until nothing changes; whatever ambiguity
+// is left goes to bipartite matching. Returns nullopt if no assignment exists.
+inline std::optional<std::vector<int>> assign_fields(std::vector<uint64_t> candidates, size_t words, size_t nr_columns, size_t nr_fields) {
+    std::vector<int> field_of(nr_columns, -1);
+    std::vector<int> column_of(nr_fields, -1);
+    std::vector<int> counts(nr_columns);
+    std::vector<size_t> singles;
+    for (size_t column = 0; column < nr_columns; ++column) {
+        for (size_t w = 0; w < words; ++w) {
+            counts[column] += std::popcount(candidates[column * words + w]);
+        }
+        if (counts[column] == 0) {
+            return std::nullopt;
+        } else if (counts[column] == 1) {
+            singles.push_back(column);
+        }
+    }
+
+    while (!singles.empty()) {
+        size_t const column = singles.back();
+        singles.pop_back();
+        if (field_of[column] >= 0) {
+            continue;
+        }
+        uint64_t const* const row = &candidates[column * words];
+        size_t const w = std::ranges::find_if(row, row + words, [](uint64_t bits) { return bits != 0; }) - row;
+        if (w == words) {
+            return std::nullopt;
+        }
+        int const field = static_cast<int>(w * 64 + std::countr_zero(row[w]));
+        field_of[column] = field;
+        column_of[field] = static_cast<int>(column);
+
+        uint64_t const bit = uint64_t{1} << (field % 64);
+        for (size_t other = 0; other < nr_columns; ++other) {
+            uint64_t& bits = candidates[other * words + field / 64];
+            if (other != column && (bits & bit)) {
+                bits &= ~bit;
+                if (--counts[other] == 1) {
+                    singles.push_back(other);
+                }
+            }
+        }
+    }
+
+    if (!match_fields(candidates, words, field_of, column_of)) {
+        return std::nullopt;
+    }
+    return field_of;
+}
+
+// The field id of each of the `nr_columns` columns (the length of your ticket), or nullopt if the
+// tickets do not determine a valid assignment. Tickets of any other length are ignored.
+inline std::optional<std::vector<int>> label_tickets(std::vector<ticket_t> const& tickets, size_t nr_columns, constraints_t const& constraints, unsigned nr_threads) {
+    field_lut const lut(constraints);
+    ticket_columns const columns(tickets, nr_columns);
+    return assign_fields(candidate_fields(columns, lut, nr_threads), lut.words(), columns.nr_columns, constraints.size());
+}
@@ -1,156 +1,147 @@
-#include "range_helpers.hpp"
+#include "input_helpers.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <iostream>
-#include <tuple>
-#include <unordered_map>
-
-struct pos_t {
-    int x{};
-    int y{};
-    int z{};
-    int w{};
-
-    inline std::strong_ordering operator<=>(pos_t const& pos) const = default;
-};
-
-namespace std {
-    template<>
-    struct hash<pos_t> {
-        size_t operator()(pos_t const& p) const {
-            std::hash<int> h;
-            auto combine = [](size_t h0, size_t h1) { return (h0 << 1) ^ h1; };
-            return combine(combine(h(p.x), h(p.y)), combine(h(p.z), h(p.w)));
+#include <string>
+#include <vector>
+
+// A D-dimensional pocket dimension on a dense, flat bounding box that grows by one cell per side
+// each cycle. Axes 0 and 1 are x and y; the other axes start out flat at 0, and because the rules
+// are symmetric under mirroring any one of them, only their non-negative half is stored. That
+// halves the work for every extra axis. Index i holds the cell at coordinate i of x and y (offset
+// by the growth so far) and at coordinate i of each mirrored axis.
+template<int D>
+class cube_world {
+    static_assert(D >= 2);
+
+public:
+    explicit cube_world(std::vector<std::string> const& lines) {
+        _extent.fill(1);
+        for (std::string const& line : lines) {
+            _extent[0] = std::max(_extent[0], static_cast<int>(line.size()));
         }
-    };
-}
-
-using world_t = std::unordered_map<pos_t, bool>;
-
-struct world_limits_t {
-    int xmin = 0;
-    int xmax = 0;
-    int ymin = 0;
-    int ymax = 0;
-    int zmin = 0;
-    int zmax = 0;
-    int wmin = 0;
-    int wmax = 0;
-
-    void expand(pos_t p) noexcept {
-        xmin = std::min(xmin, p.x);
-        xmax = std::max(xmax, p.x);
-        ymin = std::min(ymin, p.y);
-        ymax = std::max(ymax, p.y);
-        zmin = std::min(zmin, p.z);
-        zmax = std::max(zmax, p.z);
-        wmin = std::min(wmin, p.w);
-        wmax = std::max(wmax, p.w);
-    }
-};
-
-std::pair<world_t, world_limits_t> parse(std::istream& is) {
-    world_limits_t limits;
-    world_t world;
-    std::string line;
-    int y = 0;
-    while (std::getline(is, line)) {
-        for (int x = 0; x < static_cast<int>(line.length()); ++x) {
-            if (line[x] == '#') {
-                world[{x, y, 0, 0}] = true;
-                limits.expand({x, y, 0, 0});
+        _extent[1] = std::max(static_cast<int>(lines.size()), 1);
+        _cells.assign(size(_extent), 0);
+        for (size_t y = 0; y < lines.size(); ++y) {
+            for (size_t x = 0; x < lines[y].size(); ++x) {
+                _cells[y * _extent[0] + x] = lines[y][x] == '#';
             }
         }
-        ++y;
     }
-    return {world, limits};
-}
 
-int active_neighbours3(world_t const& world, pos_t pos) {
-    int count = 0;
-    for (int dx = -1; dx <= 1; ++dx) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dz = -1; dz <= 1; ++dz) {
-                auto it = world.find({pos.x + dx, pos.y + dy, pos.z + dz});
-                if ((dx != 0 || dy != 0 || dz != 0) && it != world.end() && it->second) {
-                    ++count;
+    void evolve() {
+        std::array<int, D> extent = _extent;
+        extent[0] += 2;
+        extent[1] += 2;
+        for (int axis = 2; axis < D; ++axis) {
+            extent[axis] += 1;
+        }
+
+        std::vector<uint8_t> grown(size(extent), 0);
+        for_each_cell(_extent, [&](size_t i, std::array<int, D> const& coord) {
+            std::array<int, D> shifted = coord;
+            shifted[0] += 1;
+            shifted[1] += 1;
+            grown[index(extent, shifted)] = _cells[i];
+        });
+
+        // The 3^D box sum around every cell, one axis at a time. A cell is active next cycle if
+        // it has exactly 3 active neighbours, or is active with 2; including itself, that is a
+        // box sum of 3, or of 4 when active.
+        std::vector<uint16_t> sums(grown.begin(), grown.end());
+        std::vector<uint16_t> line;
+        size_t stride = 1;
+        for (int axis = 0; axis < D; ++axis) {
+            int const n = extent[axis];
+            bool const mirrored = axis >= 2;
+            line.resize(n);
+            for (size_t outer = 0; outer < sums.size(); outer += stride * n) {
+                for (size_t inner = outer; inner < outer + stride; ++inner) {
+                    for (int k = 0; k < n; ++k) {
+                        line[k] = sums[inner + k * stride];
+                    }
+                    for (int k = 0; k < n; ++k) {
+                        uint16_t const before = k > 0 ? line[k - 1] : (mirrored && n > 1 ? line[1] : 0);
+                        uint16_t const after = k + 1 < n ? line[k + 1] : 0;
+                        sums[inner + k * stride] = before + line[k] + after;
+                    }
                 }
             }
+            stride *= n;
+        }
+
+        for (size_t i = 0; i < grown.size(); ++i) {
+            grown[i] = sums[i] == 3 || (grown[i] && sums[i] == 4);
         }
+        _cells = std::move(grown);
+        _extent = extent;
     }
-    return count;
-}
 
-void evolve3(world_t& world, world_limits_t& limits) {
-    world_t new_world;
-    world_limits_t new_limits = limits;
-    for (int x = limits.xmin-1; x <= limits.xmax+1; ++x) {
-        for (int y = limits.ymin-1; y <= limits.ymax+1; ++y) {
-            for (int z = limits.zmin-1; z <= limits.zmax+1; ++z) {
-                int const n = active_neighbours3(world, {x, y, z});
-                if ((!world[{x, y, z}] && n == 3) ||
-                    (world[{x, y, z}] && (n == 2 || n == 3))) {
-                    new_world[{x, y, z}] = true;
-                    new_limits.expand({x, y, z});
+    // Every stored cell away from 0 on a mirrored axis stands for itself and its mirror image.
+    [[nodiscard]] size_t count_active() const {
+        size_t count = 0;
+        for_each_cell(_extent, [&](size_t i, std::array<int, D> const& coord) {
+            if (_cells[i]) {
+                size_t weight = 1;
+                for (int axis = 2; axis < D; ++axis) {
+                    weight <<= coord[axis] != 0;
                 }
+                count += weight;
             }
-        }
+        });
+        return count;
     }
-    world = std::move(new_world);
-    limits = new_limits;
-}
 
+private:
+    static size_t size(std::array<int, D> const& extent) {
+        size_t ret = 1;
+        for (int n : extent) {
+            ret *= n;
+        }
+        return ret;
+    }
 
-int active_neighbours4(world_t const& world, pos_t pos) {
-    int count = 0;
-    for (int dx = -1; dx <= 1; ++dx) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            for (int dz = -1; dz <= 1; ++dz) {
-                for (int dw = -1; dw <= 1; ++dw) {
-                    auto it = world.find({pos.x + dx, pos.y + dy, pos.z + dz, pos.w + dw});
-                    if ((dx != 0 || dy != 0 || dz != 0 || dw != 0) && it != world.end() && it->second) {
-                        ++count;
-                    }
-                }
-            }
+    static size_t index(std::array<int, D> const& extent, std::array<int, D> const& coord) {
+        size_t ret = 0;
+        for (int axis = D - 1; axis >= 0; --axis) {
+            ret = ret * extent[axis] + coord[axis];
         }
+        return ret;
     }
-    return count;
-}
 
-void evolve4(world_t& world, world_limits_t& limits) {
-    world_t new_world;
-    world_limits_t new_limits = limits;
-    for (int x = limits.xmin-1; x <= limits.xmax+1; ++x) {
-        for (int y = limits.ymin-1; y <= limits.ymax+1; ++y) {
-            for (int z = limits.zmin-1; z <= limits.zmax+1; ++z) {
-                for (int w = limits.wmin-1; w <= limits.wmax+1; ++w) {
-                    int const n = active_neighbours4(world, {x, y, z, w});
-                    if ((!world[{x, y, z, w}] && n == 3) ||
-                        (world[{x, y, z, w}] && (n == 2 || n == 3))) {
-                        new_world[{x, y, z, w}] = true;
-                        new_limits.expand({x, y, z, w});
-                    }
-                }
+    // Calls fn(index, coordinates) for every cell in index order.
+    template<class F>
+    static void for_each_cell(std::array<int, D> const& extent, F fn) {
+        std::array<int, D> coord{};
+        size_t const n = size(extent);
+        for (size_t i = 0; i < n; ++i) {
+            fn(i, coord);
+            for (int axis = 0; axis < D && ++coord[axis] == extent[axis]; ++axis) {
+                coord[axis] = 0;
             }
         }
     }
-    world = std::move(new_world);
-    limits = new_limits;
-}
 
+    std::array<int, D> _extent{};
+    std::vector<uint8_t> _cells;
+};
 
-size_t count_active(world_t const& world) {
-    return world | std::views::transform([](auto& p) { return static_cast<unsigned long>(p.second); }) | accumulate(0UL);
+template<int D>
+size_t active_after(std::vector<std::string> const& lines, int cycles) {
+    cube_world<D> world(lines);
+    for (int cycle = 0; cycle < cycles; ++cycle) {
+        world.evolve();
+    }
+    return world.count_active();
 }
 
 void run() {
-    auto [world, limits] = parse(std::cin);
-    auto world4 = world;
-    auto limits4 = limits;
-
-    for (int iter = 0; iter < 6; ++iter) {
-        evolve3(world, limits);
-        evolve4(world4, limits4);
+    std::vector<std::string> lines;
+    for (std::string const& line : input_lines(std::cin)) {
+        lines.push_back(line);
     }
-    std::cout << count_active(world) << std::endl;
-    std::cout << count_active(world4) << std::endl;
+
+    std::cout << active_after<3>(lines, 6) << std::endl;
+    std::cout << active_after<4>(lines, 6) << std::endl;
 }
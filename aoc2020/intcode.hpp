@@ -1,8 +1,16 @@
 #pragma once
 
-#include <string>
-#include <regex>
-#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <ostream>
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace intcode {
     enum class opcode {
@@ -17,32 +25,62 @@ namespace intcode {
         long argument{};
     };
 
+    // Per-instruction execution counts, collected by exec when attached to a vm.
+    struct profile {
+        explicit profile(size_t program_size)
+                : executions(program_size)
+                , jumps_taken(program_size)
+        {}
+
+        void record(size_t ip, instruction const& instr) {
+            if (ip < executions.size()) {
+                executions[ip]++;
+                if (instr.code == opcode::jmp && instr.argument != 1) {
+                    jumps_taken[ip]++;
+                }
+            }
+        }
+
+        std::vector<size_t> executions;
+        std::vector<size_t> jumps_taken;
+    };
+
     struct vm {
         long acc{};
         size_t ip{};
+        intcode::profile* profile{};
     };
 
-    instruction parse(std::string const& line) {
-        static std::regex const pattern(R"(([a-z]+) ([-+]\d+))");
-        static std::unordered_map<std::string, opcode> lookup_opcode = {
-                {"acc", opcode::acc},
-                {"jmp", opcode::jmp},
-                {"nop", opcode::nop},
-        };
-        std::smatch m;
-        if (std::regex_match(line, m, pattern)) {
-            std::string const argstr = m[2].str();
-            char* endptr = nullptr;
-            long const arg = std::strtol(argstr.c_str(), &endptr, 10);
-            auto const it = lookup_opcode.find(m[1]);
-            if (it != lookup_opcode.end() && endptr == argstr.c_str() + argstr.length()) {
-                return {it->second, arg};
+    inline instruction parse(std::string_view line) {
+        // "ccc [-+]d+", parsed by hand; this is called once per line on large inputs.
+        if (line.size() < 6 || line[3] != ' ' || (line[4] != '-' && line[4] != '+')) {
+            return {opcode::error, 0};
+        }
+        std::string_view const mnemonic = line.substr(0, 3);
+        opcode code = opcode::error;
+        if (mnemonic == "acc") {
+            code = opcode::acc;
+        } else if (mnemonic == "jmp") {
+            code = opcode::jmp;
+        } else if (mnemonic == "nop") {
+            code = opcode::nop;
+        } else {
+            return {opcode::error, 0};
+        }
+        long arg = 0;
+        for (char ch : line.substr(5)) {
+            if (ch < '0' || ch > '9') {
+                return {opcode::error, 0};
             }
+            arg = arg * 10 + (ch - '0');
         }
-        return {opcode::error, 0};
+        return {code, line[4] == '-' ? -arg : arg};
     }
 
-    bool exec(vm& vm, instruction const& instr) {
+    inline bool exec(vm& vm, instruction const& instr) {
+        if (vm.profile) {
+            vm.profile->record(vm.ip, instr);
+        }
         switch (instr.code) {
             case opcode::acc:
                 vm.acc += instr.argument;
@@ -58,4 +96,553 @@ namespace intcode {
                 return false;
         }
     }
+
+    inline char const* mnemonic(opcode code) {
+        switch (code) {
+            case opcode::acc: return "acc";
+            case opcode::jmp: return "jmp";
+            case opcode::nop: return "nop";
+            default: return "???";
+        }
+    }
+
+    // Lists the most executed instructions, hottest first.
+    inline void report_hot_spots(std::ostream& os, std::vector<instruction> const& program, profile const& profile, size_t count) {
+        std::vector<size_t> ips(std::min(program.size(), profile.executions.size()));
+        std::iota(ips.begin(), ips.end(), 0);
+        count = std::min(count, ips.size());
+        std::partial_sort(ips.begin(), ips.begin() + count, ips.end(), [&](size_t ip0, size_t ip1) {
+            return std::pair(profile.executions[ip0], ip1) > std::pair(profile.executions[ip1], ip0);
+        });
+
+        size_t const total = std::accumulate(profile.executions.begin(), profile.executions.end(), size_t{0});
+        for (size_t ip : ips | std::views::take(count)) {
+            if (profile.executions[ip] == 0) {
+                break;
+            }
+            // Formatted locally so that the caller's stream flags are left alone.
+            std::ostringstream line;
+            line << std::setw(8) << ip << "  " << mnemonic(program[ip].code) << " " << std::showpos << program[ip].argument << std::noshowpos
+                 << "  executed " << profile.executions[ip]
+                 << " (" << std::fixed << std::setprecision(1) << 100.0 * profile.executions[ip] / total << "%)"
+                 << ", jumps taken " << profile.jumps_taken[ip] << "\n";
+            os << line.str();
+        }
+    }
+
+    inline void run_until_end(std::vector<instruction> const& program, vm& vm) {
+        while (vm.ip != program.size()) {
+            exec(vm, program.at(vm.ip));
+        }
+    }
+
+    enum class outcome {
+        running,
+        terminated,
+        looped,
+        out_of_bounds,
+        error,
+    };
+
+    // Runs the program until it ends, is about to repeat an instruction, or leaves the program.
+    inline outcome run_checked(std::vector<instruction> const& program, vm& vm) {
+        std::vector<bool> visited(program.size());
+        while (vm.ip < program.size()) {
+            if (visited[vm.ip]) {
+                return outcome::looped;
+            }
+            visited[vm.ip] = true;
+            if (!exec(vm, program[vm.ip])) {
+                return outcome::error;
+            }
+        }
+        return vm.ip == program.size() ? outcome::terminated : outcome::out_of_bounds;
+    }
+
+    // A program decoded into direct-threaded code: each instruction holds the address of its
+    // handler, and each handler jumps straight to the next one without a central dispatch. Decode
+    // once and run as often as needed; run() behaves like run_until_end, except that it returns
+    // whether the program ended exactly at its end, and jumping anywhere else outside the program
+    // stops it instead of throwing. Profiles are not collected.
+    class threaded_program {
+    public:
+        explicit threaded_program(std::vector<instruction> const& program)
+                : _end(program.size())
+        {
+#if defined(__GNUC__)
+            handler_table const& handlers = dispatch(nullptr, nullptr);
+            _code.resize(program.size() + 1, {handlers.halt, 0});
+            for (size_t i = 0; i < program.size(); ++i) {
+                switch (program[i].code) {
+                    case opcode::acc: _code[i] = {handlers.acc, program[i].argument}; break;
+                    case opcode::jmp: _code[i] = {handlers.jmp, program[i].argument}; break;
+                    case opcode::nop: _code[i] = {handlers.nop, program[i].argument}; break;
+                    default: _code[i] = {handlers.error, 0}; break;
+                }
+            }
+#else
+            _program = program;
+#endif
+        }
+
+        bool run(vm& vm) const {
+            if (vm.ip > _end) {
+                return false;
+            }
+#if defined(__GNUC__)
+            bool result = false;
+            dispatch(&vm, &result);
+            return result;
+#else
+            while (vm.ip < _end) {
+                if (!exec(vm, _program[vm.ip])) {
+                    return false;
+                }
+            }
+            return vm.ip == _end;
+#endif
+        }
+
+    private:
+        struct threaded {
+            void const* handler;
+            long argument;
+        };
+
+        struct handler_table {
+            void const* error;
+            void const* acc;
+            void const* jmp;
+            void const* nop;
+            void const* halt;
+        };
+
+#if defined(__GNUC__)
+        // Label addresses are only visible inside this function, so a null vm asks for the
+        // handler table instead of running the code.
+        handler_table const& dispatch(vm* vm, bool* result) const {
+            static handler_table const handlers{&&error, &&acc, &&jmp, &&nop, &&halt};
+            if (vm == nullptr) {
+                return handlers;
+            }
+
+            threaded const* const code = _code.data();
+            size_t const end = _end;
+            long acc = vm->acc;
+            size_t ip = vm->ip;
+            goto *code[ip].handler;
+        acc:
+            acc += code[ip].argument;
+            ++ip;
+            goto *code[ip].handler;
+        jmp:
+            ip += code[ip].argument;
+            if (ip > end) {
+                goto error;
+            }
+            goto *code[ip].handler;
+        nop:
+            ++ip;
+            goto *code[ip].handler;
+        error:
+            *result = false;
+            vm->acc = acc;
+            vm->ip = ip;
+            return handlers;
+        halt:
+            *result = true;
+            vm->acc = acc;
+            vm->ip = ip;
+            return handlers;
+        }
+#endif
+
+        size_t _end;
+        std::vector<threaded> _code;
+        std::vector<instruction> _program;
+    };
+
+    inline bool run_threaded(std::vector<instruction> const& program, vm& vm) {
+        return threaded_program(program).run(vm);
+    }
+
+    inline instruction flipped(instruction const& instr) {
+        if (instr.code == opcode::jmp) {
+            return {opcode::nop, instr.argument};
+        } else if (instr.code == opcode::nop) {
+            return {opcode::jmp, instr.argument};
+        } else {
+            return instr;
+        }
+    }
+
+    // Where execution goes after ip, or -1 if it leaves the program anywhere but at its end.
+    inline long successor(std::vector<instruction> const& program, size_t ip, instruction const& instr) {
+        long const next = static_cast<long>(ip) + (instr.code == opcode::jmp ? instr.argument : 1);
+        return instr.code != opcode::error && 0 <= next && next <= static_cast<long>(program.size()) ? next : -1;
+    }
+
+    // The reverse edges of a graph in which every node has at most one successor, as compressed
+    // sparse rows: the predecessors of target t are nodes[offsets[t] .. offsets[t+1]), in
+    // increasing order.
+    struct reverse_edges {
+        std::vector<size_t> offsets;
+        std::vector<size_t> nodes;
+
+        [[nodiscard]] std::span<size_t const> of(size_t target) const {
+            return {nodes.data() + offsets[target], nodes.data() + offsets[target + 1]};
+        }
+    };
+
+    // `successor(node)` gives the successor of each of the nr_nodes nodes, below nr_targets, or a
+    // negative number for none.
+    template<class Successor>
+    reverse_edges build_reverse_edges(size_t nr_nodes, size_t nr_targets, Successor successor) {
+        reverse_edges edges;
+        edges.offsets.assign(nr_targets + 1, 0);
+        for (size_t node = 0; node < nr_nodes; ++node) {
+            long const next = successor(node);
+            if (next >= 0) {
+                edges.offsets[next + 1]++;
+            }
+        }
+        std::partial_sum(edges.offsets.begin(), edges.offsets.end(), edges.offsets.begin());
+        edges.nodes.resize(edges.offsets.back());
+        std::vector<size_t> fill(edges.offsets.begin(), edges.offsets.end() - 1);
+        for (size_t node = 0; node < nr_nodes; ++node) {
+            long const next = successor(node);
+            if (next >= 0) {
+                edges.nodes[fill[next]++] = node;
+            }
+        }
+        return edges;
+    }
+
+    struct fix {
+        size_t ip{};
+        long acc{};
+    };
+
+    // Every instruction that, flipped between jmp and nop, makes a looping program terminate,
+    // together with the final accumulator of the fixed program. Runs in O(n): the instructions
+    // that reach the end are marked by a search backwards from the end, and then each instruction
+    // on the original path is checked once. A flipped instruction is only executed once, since
+    // the rest of the path lies in the terminating region, which the original path never enters.
+    // A program that already terminates has no fixes.
+    inline std::vector<fix> find_fixes(std::vector<instruction> const& program) {
+        size_t const n = program.size();
+
+        reverse_edges const predecessors = build_reverse_edges(n, n + 1, [&](size_t ip) {
+            return successor(program, ip, program[ip]);
+        });
+
+        // The terminating region, with the accumulator gained on the way from each instruction
+        // to the end.
+        std::vector<bool> terminates(n + 1);
+        std::vector<long> acc_to_end(n + 1);
+        std::vector<size_t> queue{n};
+        terminates[n] = true;
+        for (size_t i = 0; i < queue.size(); ++i) {
+            size_t const ip = queue[i];
+            for (size_t pred : predecessors.of(ip)) {
+                terminates[pred] = true;
+                acc_to_end[pred] = acc_to_end[ip] + (program[pred].code == opcode::acc ? program[pred].argument : 0);
+                queue.push_back(pred);
+            }
+        }
+        if (n == 0 || terminates[0]) {
+            return {};
+        }
+
+        std::vector<fix> fixes;
+        std::vector<bool> visited(n);
+        vm vm{};
+        while (vm.ip < n && !visited[vm.ip]) {
+            visited[vm.ip] = true;
+            instruction const& instr = program[vm.ip];
+            if (instr.code == opcode::jmp || instr.code == opcode::nop) {
+                long const next = successor(program, vm.ip, flipped(instr));
+                if (next >= 0 && terminates[next]) {
+                    fixes.push_back({vm.ip, vm.acc + acc_to_end[next]});
+                }
+            }
+            exec(vm, instr);
+        }
+        return fixes;
+    }
+
+    // A straight run of instructions that is only entered at its first instruction and only left
+    // after its last one. Every block has exactly one successor, since there are no conditional
+    // jumps.
+    struct basic_block {
+        size_t begin{};
+        size_t end{};
+        long acc_delta{};
+        size_t successor{};
+    };
+
+    // The control flow graph of a program, with static facts about it. The exit of the program
+    // is the pseudo-block exit(), and blocks that jump outside the program, or stop at an error
+    // instruction, have the successor stuck().
+    struct control_flow_graph {
+        std::vector<basic_block> blocks;
+        std::vector<size_t> block_of;
+        // Indexed by block, with exit() and stuck() as the last two targets.
+        reverse_edges predecessors;
+        // Blocks on a cycle share the index of that cycle; the other blocks have no_cycle. Since
+        // every block has one successor, the cycles are exactly the non-trivial SCCs.
+        std::vector<size_t> cycle_of;
+        std::vector<bool> reaches_exit;
+        size_t cycles{};
+
+        static constexpr size_t no_cycle = -1;
+
+        [[nodiscard]] size_t exit() const {
+            return blocks.size();
+        }
+
+        [[nodiscard]] size_t stuck() const {
+            return blocks.size() + 1;
+        }
+
+        [[nodiscard]] bool is_block_start(size_t ip) const {
+            return ip < block_of.size() && (ip == 0 || block_of[ip - 1] != block_of[ip]);
+        }
+
+        // Whether the program terminates when started at ip 0, decided without running it.
+        [[nodiscard]] bool terminates() const {
+            return blocks.empty() || reaches_exit[0];
+        }
+    };
+
+    inline control_flow_graph build_cfg(std::vector<instruction> const& program) {
+        size_t const n = program.size();
+        control_flow_graph cfg;
+
+        std::vector<bool> leader(n + 1);
+        leader[0] = true;
+        for (size_t ip = 0; ip < n; ++ip) {
+            long const target = static_cast<long>(ip) + program[ip].argument;
+            if (program[ip].code == opcode::jmp || program[ip].code == opcode::error) {
+                leader[ip + 1] = true;
+            }
+            if (program[ip].code == opcode::error) {
+                leader[ip] = true;
+            }
+            if (program[ip].code == opcode::jmp && 0 <= target && target < static_cast<long>(n)) {
+                leader[target] = true;
+            }
+        }
+
+        cfg.block_of.resize(n);
+        for (size_t ip = 0; ip < n; ++ip) {
+            if (leader[ip]) {
+                basic_block block;
+                block.begin = ip;
+                block.end = ip;
+                cfg.blocks.push_back(block);
+            }
+            basic_block& block = cfg.blocks.back();
+            block.end = ip + 1;
+            if (program[ip].code == opcode::acc) {
+                block.acc_delta += program[ip].argument;
+            }
+            cfg.block_of[ip] = cfg.blocks.size() - 1;
+        }
+
+        for (size_t b = 0; b < cfg.blocks.size(); ++b) {
+            basic_block& block = cfg.blocks[b];
+            long const next = successor(program, block.end - 1, program[block.end - 1]);
+            if (program[block.end - 1].code == opcode::error || next < 0) {
+                block.successor = cfg.stuck();
+            } else if (next == static_cast<long>(n)) {
+                block.successor = cfg.exit();
+            } else {
+                block.successor = cfg.block_of[next];
+            }
+        }
+        cfg.predecessors = build_reverse_edges(cfg.blocks.size(), cfg.blocks.size() + 2, [&](size_t b) {
+            return static_cast<long>(cfg.blocks[b].successor);
+        });
+
+        // Cycles of the successor function, found by walking from every block until the walk
+        // meets a block that is already done, or one on the current walk.
+        size_t const blocks = cfg.blocks.size();
+        cfg.cycle_of.assign(blocks, control_flow_graph::no_cycle);
+        std::vector<size_t> walk_of(blocks, -1);
+        for (size_t start = 0; start < blocks; ++start) {
+            size_t b = start;
+            while (b < blocks && walk_of[b] == static_cast<size_t>(-1)) {
+                walk_of[b] = start;
+                b = cfg.blocks[b].successor;
+            }
+            if (b < blocks && walk_of[b] == start) {
+                for (size_t c = b; cfg.cycle_of[c] == control_flow_graph::no_cycle; c = cfg.blocks[c].successor) {
+                    cfg.cycle_of[c] = cfg.cycles;
+                }
+                cfg.cycles++;
+            }
+        }
+
+        cfg.reaches_exit.assign(blocks, false);
+        std::vector<size_t> queue;
+        for (size_t b : cfg.predecessors.of(cfg.exit())) {
+            cfg.reaches_exit[b] = true;
+            queue.push_back(b);
+        }
+        for (size_t i = 0; i < queue.size(); ++i) {
+            for (size_t pred : cfg.predecessors.of(queue[i])) {
+                cfg.reaches_exit[pred] = true;
+                queue.push_back(pred);
+            }
+        }
+        return cfg;
+    }
+
+    // Like run_checked, but a block at a time. Starting anywhere but at a block start falls back
+    // to run_checked.
+    inline outcome run_blocks(control_flow_graph const& cfg, std::vector<instruction> const& program, vm& vm) {
+        if (vm.ip < program.size() && !cfg.is_block_start(vm.ip)) {
+            return run_checked(program, vm);
+        }
+        std::vector<bool> visited(cfg.blocks.size());
+        while (vm.ip < program.size()) {
+            size_t const b = cfg.block_of[vm.ip];
+            basic_block const& block = cfg.blocks[b];
+            if (visited[b]) {
+                return outcome::looped;
+            }
+            visited[b] = true;
+            if (program[block.begin].code == opcode::error) {
+                return outcome::error;
+            }
+            vm.acc += block.acc_delta;
+            instruction const& last = program[block.end - 1];
+            vm.ip = block.end - 1 + (last.code == opcode::jmp ? last.argument : 1);
+        }
+        return vm.ip == program.size() ? outcome::terminated : outcome::out_of_bounds;
+    }
+
+    // Runs many copies of one program side by side, each with at most one instruction flipped
+    // between jmp and nop. Lanes are kept as structure-of-arrays with 32-bit ips and stepped with
+    // branch-free arithmetic (see step_lanes), and the program is pre-decoded into ip and
+    // acc deltas, with a sentinel at the end whose deltas are zero. A lane that runs more steps
+    // than the program has instructions must have repeated one, so it is retired as looping.
+    class vm_batch {
+    public:
+        using outcome = intcode::outcome;
+
+        static constexpr long no_patch = -1;
+
+        explicit vm_batch(std::vector<instruction> const& program)
+                : _end(static_cast<int32_t>(program.size()))
+                , _ip_delta(program.size() + 1, 0)
+                , _flipped_ip_delta(program.size() + 1, 0)
+                , _acc_delta(program.size() + 1, 0)
+        {
+            for (size_t i = 0; i < program.size(); ++i) {
+                // Jumps out of the program are clamped to land just outside it, so ips fit in 32
+                // bits.
+                auto delta = [&](instruction const& instr) {
+                    if (instr.code == opcode::error) {
+                        return int32_t{0};
+                    }
+                    long const target = static_cast<long>(i) + (instr.code == opcode::jmp ? instr.argument : 1);
+                    return static_cast<int32_t>(std::clamp<long>(target, -1, _end + 1) - static_cast<long>(i));
+                };
+                _ip_delta[i] = delta(program[i]);
+                _flipped_ip_delta[i] = delta(flipped(program[i]));
+                _acc_delta[i] = program[i].code == opcode::acc ? program[i].argument : 0;
+            }
+        }
+
+        // Adds a lane starting at ip 0 and returns its index.
+        size_t add(long patch_ip = no_patch) {
+            _lanes.push_back(_ips.size());
+            _ips.push_back(0);
+            _accs.push_back(0);
+            _patches.push_back(0 <= patch_ip && patch_ip < _end ? static_cast<int32_t>(patch_ip) : no_patch);
+            _results.push_back({outcome::running, 0});
+            return _results.size() - 1;
+        }
+
+        // Steps all running lanes until every lane has retired.
+        void run() {
+            constexpr long chunk = 64;
+            long steps = 0;
+            while (!_lanes.empty()) {
+                for (long step = 0; step < chunk; ++step) {
+                    step_lanes(_ips.size(), _end, _ips.data(), _accs.data(), _patches.data(),
+                               _ip_delta.data(), _flipped_ip_delta.data(), _acc_delta.data());
+                }
+                steps += chunk;
+                retire(steps);
+            }
+        }
+
+        [[nodiscard]] outcome result(size_t lane) const {
+            return _results[lane].first;
+        }
+
+        // The accumulator when the lane retired. Only meaningful for terminated and out_of_bounds
+        // lanes: a looped lane is retired some way past its first repeated instruction, so its
+        // accumulator is not the one at the loop point. Use run_checked for that.
+        [[nodiscard]] long acc(size_t lane) const {
+            return _results[lane].second;
+        }
+
+    private:
+        // One step of every lane. The arrays are passed as restrict parameters and both ip deltas
+        // are loaded unconditionally, so that the loop has no aliasing or control flow in the way
+        // of vectorisation; the table loads become gathers.
+        static void step_lanes(size_t lanes, int32_t end, int32_t* __restrict ips, long* __restrict accs,
+                               int32_t const* __restrict patches, int32_t const* __restrict ip_delta,
+                               int32_t const* __restrict flipped_ip_delta, long const* __restrict acc_delta) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                int32_t const ip = ips[lane];
+                int32_t const i = static_cast<uint32_t>(ip) <= static_cast<uint32_t>(end) ? ip : end;
+                int32_t const delta = ip_delta[i];
+                int32_t const flipped_delta = flipped_ip_delta[i];
+                accs[lane] += acc_delta[i];
+                ips[lane] = ip + (ip == patches[lane] ? flipped_delta : delta);
+            }
+        }
+
+        // Moves finished lanes out of the arrays that are stepped.
+        void retire(long steps) {
+            size_t lane = 0;
+            while (lane < _ips.size()) {
+                int32_t const ip = _ips[lane];
+                outcome const o =
+                        ip == _end ? outcome::terminated :
+                        ip < 0 || ip > _end ? outcome::out_of_bounds :
+                        steps > _end ? outcome::looped :
+                        outcome::running;
+                if (o == outcome::running) {
+                    ++lane;
+                    continue;
+                }
+                _results[_lanes[lane]] = {o, _accs[lane]};
+                _lanes[lane] = _lanes.back();
+                _ips[lane] = _ips.back();
+                _accs[lane] = _accs.back();
+                _patches[lane] = _patches.back();
+                _lanes.pop_back();
+                _ips.pop_back();
+                _accs.pop_back();
+                _patches.pop_back();
+            }
+        }
+
+        int32_t _end;
+        std::vector<int32_t> _ip_delta;
+        std::vector<int32_t> _flipped_ip_delta;
+        std::vector<long> _acc_delta;
+
+        std::vector<size_t> _lanes;
+        std::vector<int32_t> _ips;
+        std::vector<long> _accs;
+        std::vector<int32_t> _patches;
+        std::vector<std::pair<outcome, long>> _results;
+    };
 }
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "intcode.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define INTCODE_JIT 1
+#include <sys/mman.h>
+#endif
+
+namespace intcode {
+    // Compiles a program to x86-64 machine code in an executable mapping. run() has the same
+    // semantics as run_checked. The visited flags are only checked at block leaders (ip 0 and
+    // jump targets): the first instruction to repeat is always reached by a jump, so this finds
+    // the same repeat as checking every instruction. On other hosts, and when starting at an ip
+    // that is not a leader, it falls back to run_checked.
+    class jit_program {
+    public:
+        explicit jit_program(std::vector<instruction> const& program)
+                : _program(program)
+                , _leader(program.size() + 1)
+        {
+            if (!_program.empty()) {
+                _leader[0] = true;
+            }
+            for (size_t ip = 0; ip < program.size(); ++ip) {
+                long const target = static_cast<long>(ip) + program[ip].argument;
+                if (program[ip].code == opcode::jmp && 0 <= target && target < static_cast<long>(program.size())) {
+                    _leader[target] = true;
+                }
+            }
+#if defined(INTCODE_JIT)
+            compile();
+#endif
+        }
+
+        jit_program(jit_program const&) = delete;
+        jit_program& operator=(jit_program const&) = delete;
+
+        ~jit_program() {
+#if defined(INTCODE_JIT)
+            if (_code != nullptr) {
+                munmap(_code, _code_size);
+            }
+#endif
+        }
+
+        [[nodiscard]] bool is_compiled() const {
+            return _code != nullptr;
+        }
+
+        outcome run(vm& vm) const {
+#if defined(INTCODE_JIT)
+            if (_code != nullptr && vm.ip < _program.size() && _leader[vm.ip]) {
+                using entry_fn = long (*)(uint8_t* visited, long* acc, void const* entry);
+                std::vector<uint8_t> visited(_program.size());
+                long const ip = reinterpret_cast<entry_fn>(_code)(visited.data(), &vm.acc, static_cast<uint8_t const*>(_code) + _offsets[vm.ip]);
+                vm.ip = ip;
+                if (ip == static_cast<long>(_program.size())) {
+                    return outcome::terminated;
+                } else if (ip < 0 || ip > static_cast<long>(_program.size())) {
+                    return outcome::out_of_bounds;
+                } else if (_program[ip].code == opcode::error) {
+                    return outcome::error;
+                } else {
+                    return outcome::looped;
+                }
+            }
+#endif
+            return run_checked(_program, vm);
+        }
+
+    private:
+#if defined(INTCODE_JIT)
+        // Generated code: long f(uint8_t* visited [rdi], long* acc [rsi], void* entry [rdx]).
+        // The accumulator lives in rax while running, and the exit ip is returned in rax.
+        void compile() {
+            std::vector<uint8_t> code;
+            auto emit8 = [&](uint8_t x) { code.push_back(x); };
+            auto emit32 = [&](int32_t x) { uint8_t b[4]; std::memcpy(b, &x, 4); code.insert(code.end(), b, b + 4); };
+            auto emit64 = [&](int64_t x) { uint8_t b[8]; std::memcpy(b, &x, 8); code.insert(code.end(), b, b + 8); };
+            auto emit_exit = [&](long ip) {
+                emit8(0x48); emit8(0x89); emit8(0x06);  // mov [rsi], rax
+                emit8(0x48); emit8(0xB8); emit64(ip);   // mov rax, ip
+                emit8(0xC3);                            // ret
+            };
+            auto fits32 = [](long x) {
+                return std::numeric_limits<int32_t>::min() <= x && x <= std::numeric_limits<int32_t>::max();
+            };
+            if (!fits32(static_cast<long>(_program.size()))) {
+                return;
+            }
+
+            emit8(0x48); emit8(0x8B); emit8(0x06);  // mov rax, [rsi]
+            emit8(0xFF); emit8(0xE2);               // jmp rdx
+
+            std::vector<std::pair<size_t, size_t>> jumps;
+            _offsets.resize(_program.size() + 1);
+            for (size_t ip = 0; ip < _program.size(); ++ip) {
+                _offsets[ip] = code.size();
+                auto const disp = static_cast<int32_t>(ip);
+                if (_leader[ip]) {
+                    emit8(0x80); emit8(0xBF); emit32(disp); emit8(0x00);  // cmp byte [rdi+ip], 0
+                    emit8(0x74); emit8(0x0E);                               // je mark
+                    emit_exit(static_cast<long>(ip));
+                    emit8(0xC6); emit8(0x87); emit32(disp); emit8(0x01);  // mark: mov byte [rdi+ip], 1
+                }
+
+                instruction const& instr = _program[ip];
+                long const target = static_cast<long>(ip) + instr.argument;
+                switch (instr.code) {
+                    case opcode::acc:
+                        if (fits32(instr.argument)) {
+                            emit8(0x48); emit8(0x05); emit32(static_cast<int32_t>(instr.argument));  // add rax, imm32
+                        } else {
+                            emit8(0x48); emit8(0xB9); emit64(instr.argument);  // mov rcx, imm64
+                            emit8(0x48); emit8(0x01); emit8(0xC8);             // add rax, rcx
+                        }
+                        break;
+                    case opcode::nop:
+                        break;
+                    case opcode::jmp:
+                        if (0 <= target && target <= static_cast<long>(_program.size())) {
+                            emit8(0xE9);  // jmp rel32
+                            jumps.emplace_back(code.size(), target);
+                            emit32(0);
+                        } else {
+                            emit_exit(target);
+                        }
+                        break;
+                    default:
+                        emit_exit(static_cast<long>(ip));
+                        break;
+                }
+            }
+            _offsets[_program.size()] = code.size();
+            emit_exit(static_cast<long>(_program.size()));
+
+            for (auto const& [at, target] : jumps) {
+                long const rel = static_cast<long>(_offsets[target]) - static_cast<long>(at + 4);
+                if (!fits32(rel)) {
+                    return;
+                }
+                auto const rel32 = static_cast<int32_t>(rel);
+                std::memcpy(&code[at], &rel32, 4);
+            }
+
+            void* const mem = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem == MAP_FAILED) {
+                return;
+            }
+            std::memcpy(mem, code.data(), code.size());
+            if (mprotect(mem, code.size(), PROT_READ | PROT_EXEC) != 0) {
+                munmap(mem, code.size());
+                return;
+            }
+            _code = mem;
+            _code_size = code.size();
+        }
+#endif
+
+        std::vector<instruction> _program;
+        std::vector<bool> _leader;
+        std::vector<size_t> _offsets;
+        void* _code = nullptr;
+        size_t _code_size = 0;
+    };
+}
@@ -1,5 +1,15 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <optional>
+#include <ostream>
 #include <ranges>
+#include <string>
+#include <utility>
+#include <vector>
 
 inline long extended_euclidian(long r0, long r1, long& inv0, long& inv1) {
     long s0 = 1;
@@ -23,41 +33,267 @@ inline long extended_euclidian(long r0, long r1, long& inv0, long& inv1) {
     return r0;
 }
 
+// A non-negative integer of any size, with just the operations the CRT needs.
+class big_unsigned {
+public:
+    big_unsigned() = default;
+
+    explicit big_unsigned(unsigned long x) {
+        *this += x;
+    }
+
+    big_unsigned& operator+=(unsigned long x) {
+        unsigned __int128 carry = x;
+        for (size_t i = 0; carry != 0; ++i) {
+            if (i == _limbs.size()) {
+                _limbs.push_back(0);
+            }
+            carry += _limbs[i];
+            _limbs[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return *this;
+    }
+
+    big_unsigned& operator+=(big_unsigned const& x) {
+        if (_limbs.size() < x._limbs.size()) {
+            _limbs.resize(x._limbs.size(), 0);
+        }
+        uint64_t carry = 0;
+        for (size_t i = 0; i < _limbs.size() && (i < x._limbs.size() || carry != 0); ++i) {
+            carry += uint64_t{_limbs[i]} + (i < x._limbs.size() ? x._limbs[i] : 0);
+            _limbs[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        if (carry != 0) {
+            _limbs.push_back(static_cast<uint32_t>(carry));
+        }
+        return *this;
+    }
+
+    // Requires x <= *this.
+    big_unsigned& operator-=(big_unsigned const& x) {
+        int64_t borrow = 0;
+        for (size_t i = 0; i < _limbs.size() && (i < x._limbs.size() || borrow != 0); ++i) {
+            int64_t diff = int64_t{_limbs[i]} - (i < x._limbs.size() ? x._limbs[i] : 0) - borrow;
+            borrow = diff < 0;
+            _limbs[i] = static_cast<uint32_t>(diff + (borrow << 32));
+        }
+        trim();
+        return *this;
+    }
+
+    big_unsigned& operator*=(unsigned long x) {
+        unsigned __int128 carry = 0;
+        for (uint32_t& limb : _limbs) {
+            carry += static_cast<unsigned __int128>(limb) * x;
+            limb = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        for (; carry != 0; carry >>= 32) {
+            _limbs.push_back(static_cast<uint32_t>(carry));
+        }
+        trim();
+        return *this;
+    }
+
+    // Divides in place and returns the remainder.
+    unsigned long divide(unsigned long x) {
+        unsigned __int128 rem = 0;
+        for (size_t i = _limbs.size(); i-- > 0;) {
+            rem = (rem << 32) | _limbs[i];
+            _limbs[i] = static_cast<uint32_t>(rem / x);
+            rem %= x;
+        }
+        trim();
+        return static_cast<unsigned long>(rem);
+    }
+
+    [[nodiscard]] bool fits_long() const {
+        return _limbs.size() < 2 || (_limbs.size() == 2 && _limbs[1] < 0x80000000U);
+    }
+
+    [[nodiscard]] long to_long() const {
+        unsigned long x = 0;
+        for (size_t i = _limbs.size(); i-- > 0;) {
+            x = (x << 32) | _limbs[i];
+        }
+        return static_cast<long>(x);
+    }
+
+    [[nodiscard]] std::string to_string() const {
+        big_unsigned x = *this;
+        std::vector<unsigned long> groups;
+        do {
+            groups.push_back(x.divide(1'000'000'000UL));
+        } while (!x._limbs.empty());
+        std::string ret = std::to_string(groups.back());
+        for (size_t i = groups.size() - 1; i-- > 0;) {
+            std::string const group = std::to_string(groups[i]);
+            ret += std::string(9 - group.size(), '0') + group;
+        }
+        return ret;
+    }
+
+    friend bool operator==(big_unsigned const&, big_unsigned const&) = default;
+
+    friend std::ostream& operator<<(std::ostream& os, big_unsigned const& x) {
+        return os << x.to_string();
+    }
+
+private:
+    void trim() {
+        while (!_limbs.empty() && _limbs.back() == 0) {
+            _limbs.pop_back();
+        }
+    }
+
+    std::vector<uint32_t> _limbs;
+};
+
+struct congruence {
+    long remainder{};
+    long modulus{};
+};
+
 namespace detail {
-    inline long huge_mult(long x, long y, long mod, long acc = 0) {
-        // Invariant: x*y + acc == answer
-        if (x == 0) {
-            return acc;
-        } else if (x < 0) {
-            return huge_mult(-x, -y, mod, -acc);
-        } else if (x % 2 == 0) {
-            return huge_mult(x / 2, (y*2) % mod, mod, acc);
-        } else {
-            return huge_mult(x-1, y, mod, (acc + y) % mod);
+    inline long mul_mod(long x, long y, long mod) {
+        return static_cast<long>(static_cast<__int128>(x) * y % mod);
+    }
+
+    inline long reduce(long x, long mod) {
+        long const r = x % mod;
+        return r < 0 ? r + mod : r;
+    }
+
+    inline long inverse(long x, long mod) {
+        long inv_x{}, inv_mod{};
+        extended_euclidian(reduce(x, mod), mod, inv_x, inv_mod);
+        return reduce(inv_x, mod);
+    }
+
+    // Merges two congruences into one modulo lcm(m1, m2). Returns false if they contradict each
+    // other; leaves `merged` untouched if the lcm does not fit in a long.
+    inline bool merge(congruence a, congruence b, std::optional<congruence>& merged) {
+        long const g = std::gcd(a.modulus, b.modulus);
+        long const diff = b.remainder - a.remainder;
+        if (diff % g != 0) {
+            return false;
+        }
+        long const step = a.modulus / g;
+        if (step > std::numeric_limits<long>::max() / b.modulus) {
+            return true;
+        }
+        long const mod = b.modulus / g;
+        long const t = mul_mod(reduce(diff / g, mod), inverse(step, mod), mod);
+        merged = congruence{a.remainder + a.modulus * t, step * b.modulus};
+        return true;
+    }
+
+    // Splits lcm(m1, m2) into coprime factors a | m1 and b | m2 with a * b == lcm(m1, m2): shared
+    // factors are moved over to b until none are left.
+    inline std::pair<long, long> coprime_split(long m1, long m2) {
+        long a = m1;
+        long b = m2 / std::gcd(m1, m2);
+        for (long g = std::gcd(a, b); g != 1; g = std::gcd(a, b)) {
+            a /= g;
+            b *= g;
+        }
+        return {a, b};
+    }
+
+    // Makes the moduli pairwise coprime without changing the solutions, by replacing every
+    // non-coprime pair with its coprime_split. Moduli only shrink, so pairs that are already
+    // coprime stay coprime. Returns false if two congruences contradict each other.
+    inline bool make_coprime(std::vector<congruence>& congruences) {
+        for (size_t i = 0; i < congruences.size(); ++i) {
+            for (size_t j = i + 1; j < congruences.size(); ++j) {
+                congruence& a = congruences[i];
+                congruence& b = congruences[j];
+                long const g = std::gcd(a.modulus, b.modulus);
+                if (g == 1) {
+                    continue;
+                } else if ((b.remainder - a.remainder) % g != 0) {
+                    return false;
+                }
+                std::tie(a.modulus, b.modulus) = coprime_split(a.modulus, b.modulus);
+                a.remainder %= a.modulus;
+                b.remainder %= b.modulus;
+            }
         }
+        return true;
     }
 }
 
+// Solves a system of congruences x = r_i (mod m_i) for the smallest non-negative x. Moduli need
+// not be coprime; an inconsistent system gives nullopt. Congruences are merged pairwise in a
+// balanced tree with 128-bit intermediates for as long as the merged moduli fit in a long.
+// Whatever groups remain are made coprime and combined with Garner's mixed-radix algorithm,
+// which only needs word-sized arithmetic until the final value is assembled in a big_unsigned.
+inline std::optional<big_unsigned> solve_congruences(std::vector<congruence> const& congruences) {
+    std::vector<congruence> level;
+    for (auto const& c : congruences) {
+        level.push_back({detail::reduce(c.remainder, c.modulus), c.modulus});
+    }
+    // Sort so that small moduli meet small moduli.
+    auto const by_modulus = [](auto const& a, auto const& b) { return a.modulus < b.modulus; };
+    std::sort(level.begin(), level.end(), by_modulus);
+
+    bool merged = true;
+    while (level.size() > 1 && merged) {
+        merged = false;
+        std::vector<congruence> next;
+        for (size_t i = 0; i < level.size(); i += 2) {
+            if (i + 1 == level.size()) {
+                next.push_back(level[i]);
+                continue;
+            }
+            std::optional<congruence> pair;
+            if (!detail::merge(level[i], level[i + 1], pair)) {
+                return std::nullopt;
+            } else if (pair) {
+                next.push_back(*pair);
+                merged = true;
+            } else {
+                next.push_back(level[i]);
+                next.push_back(level[i + 1]);
+            }
+        }
+        level = std::move(next);
+        std::sort(level.begin(), level.end(), by_modulus);
+    }
+
+    if (!detail::make_coprime(level)) {
+        return std::nullopt;
+    }
+    std::vector<long> digits(level.size());
+    for (size_t i = 0; i < level.size(); ++i) {
+        long const m = level[i].modulus;
+        long t = level[i].remainder;
+        for (size_t j = 0; j < i; ++j) {
+            t = detail::mul_mod(detail::reduce(t - digits[j], m), detail::inverse(level[j].modulus, m), m);
+        }
+        digits[i] = t;
+    }
+
+    big_unsigned x;
+    for (size_t i = level.size(); i-- > 0;) {
+        x *= level[i].modulus;
+        x += digits[i];
+    }
+    return x;
+}
+
 template<std::ranges::input_range RemRng, std::ranges::input_range ModRng>
         requires std::is_convertible_v<std::ranges::range_value_t<RemRng>, long> &&
                  std::is_convertible_v<std::ranges::range_value_t<ModRng>, long>
 inline long chinese_remainder(RemRng&& remainders, ModRng&& moduli) {
-    auto reduce = [](long x, long m) {
-        return ((x % m) + m) % m;
-    };
-
-    long x = 0;
-    long mod = 1;
+    std::vector<congruence> congruences;
     auto remainder_it = begin(remainders);
     auto modulus_it = begin(moduli);
     for (; remainder_it != end(remainders) && modulus_it != end(moduli); ++remainder_it, ++modulus_it) {
-        long const r = *remainder_it;
-        long const m = *modulus_it;
-        long inv_mod{}, inv_m{};
-        extended_euclidian(mod, m, inv_mod, inv_m);
-
-        x = reduce(x + detail::huge_mult(r - x, inv_mod * mod, mod*m), mod*m);
-        mod = m * mod;
+        congruences.push_back({*remainder_it, *modulus_it});
     }
-    return x;
+    auto const x = solve_congruences(congruences);
+    return x && x->fits_long() ? x->to_long() : -1;
 }
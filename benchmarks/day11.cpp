@@ -0,0 +1,38 @@
+#include "day11.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+// A random seating area with roughly one floor tile in five.
+seating_area generate_area(int rows, int cols, unsigned seed) {
+    std::mt19937 rng(seed);
+    seating_area area{std::vector<seat>(static_cast<size_t>(rows) * cols), cols};
+    for (seat& s : area.seats) {
+        s = rng() % 5 == 0 ? seat::floor : seat::empty;
+    }
+    return area;
+}
+
+template<class F>
+void bench(char const* name, F run) {
+    auto const start = std::chrono::steady_clock::now();
+    seating_area const stable = run();
+    auto const elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": " << elapsed.count() << " ms ("
+              << std::count(stable.seats.begin(), stable.seats.end(), seat::occupied) << " occupied)" << std::endl;
+}
+
+int main() {
+    seating_area const area = generate_area(500, 500, 11);
+    auto const visible = visible_seats(area);
+    neighbour_rule const rule{visible, 5};
+    std::cout << "500x500, line of sight, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+    bench("  serial    ", [&] { return evolve_until_stable(area, rule); });
+    bench("  bitsliced ", [&] { return evolve_until_stable_bitsliced(area, true, 5); });
+    bench("  worklist  ", [&] { return evolve_until_stable_worklist(area, visible, 5); });
+    for (unsigned threads = 1; threads <= std::max(std::thread::hardware_concurrency(), 4U); threads *= 2) {
+        std::string const name = "  " + std::to_string(threads) + " threads";
+        bench(name.c_str(), [&] { return evolve_until_stable_parallel(area, rule, threads); });
+    }
+}
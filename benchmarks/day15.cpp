@@ -0,0 +1,57 @@
+#include "day15.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+// The original store, for comparison.
+class map_last_seen {
+public:
+    uint32_t exchange(uint32_t number, uint32_t turn) {
+        auto [it, inserted] = _turns.try_emplace(number, turn);
+        if (inserted) {
+            return 0;
+        }
+        return std::exchange(it->second, turn);
+    }
+
+    [[nodiscard]] size_t memory_bytes() const {
+        // Roughly one node (key, value, next pointer) per entry plus the bucket array.
+        return _turns.size() * 24 + _turns.bucket_count() * sizeof(void*);
+    }
+
+private:
+    std::unordered_map<uint32_t, uint32_t> _turns;
+};
+
+template<class LastSeen>
+void bench(std::string const& name, uint32_t nr_turns, LastSeen last_seen) {
+    std::vector<int> const starting_numbers{18, 11, 9, 0, 5, 1};
+    auto const start = std::chrono::steady_clock::now();
+    uint32_t spoken{};
+    try {
+        spoken = play_memory_game(starting_numbers, nr_turns, {nr_turns}, last_seen).front();
+    } catch (std::length_error const&) {
+        std::cout << name << ": over the memory limit" << std::endl;
+        return;
+    }
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": " << elapsed.count() << " s, " << (last_seen.memory_bytes() >> 20) << " MiB ("
+              << spoken << ")" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    uint32_t const nr_turns = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 30000000;
+    size_t const nr_numbers = memory_game_numbers({18, 11, 9, 0, 5, 1}, nr_turns);
+    std::cout << nr_turns << " turns" << std::endl;
+
+    bench("  unordered_map ", nr_turns, map_last_seen{});
+    bench("  dense         ", nr_turns, dense_last_seen(nr_numbers));
+    // Memory limits as a fraction of the dense array.
+    for (size_t percent : {25, 50, 75}) {
+        std::string const name = "  tiered " + std::to_string(percent) + "%";
+        size_t const limit = nr_numbers * sizeof(uint32_t) / 100 * percent;
+        bench(name + std::string(16 - name.size(), ' '), nr_turns, tiered_last_seen(nr_numbers, limit));
+    }
+}
@@ -0,0 +1,93 @@
+#include "intcode.hpp"
+#include "intcode_jit.hpp"
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Straight-line program of the given length, with short forward jumps mixed in so that most,
+// but not all, instructions are executed.
+std::vector<intcode::instruction> generate_program(size_t length, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pick_code(0, 9);
+    std::uniform_int_distribution<long> pick_acc(-100, 100);
+    std::uniform_int_distribution<long> pick_jump(1, 3);
+    std::vector<intcode::instruction> program;
+    program.reserve(length);
+    for (size_t i = 0; i < length; ++i) {
+        int const code = pick_code(rng);
+        if (code < 6) {
+            program.push_back({intcode::opcode::acc, pick_acc(rng)});
+        } else if (code < 8) {
+            program.push_back({intcode::opcode::nop, pick_acc(rng)});
+        } else {
+            long const jump = std::min<long>(pick_jump(rng), static_cast<long>(length - i));
+            program.push_back({intcode::opcode::jmp, jump});
+        }
+    }
+    return program;
+}
+
+template<class F>
+void bench(char const* name, std::vector<intcode::instruction> const& program, F run, int repeats) {
+    long acc = 0;
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        intcode::vm vm{};
+        run(program, vm);
+        acc = vm.acc;
+    }
+    auto const elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": " << elapsed.count() / repeats << " ms/run (acc " << acc << ")" << std::endl;
+}
+
+// Checks every possible patch of a looping program, one vm at a time and as a batch.
+void bench_patch_search(size_t length) {
+    auto program = generate_program(length, 2021);
+    program.back() = {intcode::opcode::jmp, -static_cast<long>(length - 1)};
+    std::cout << "patch search over " << length << " instructions" << std::endl;
+
+    auto const start = std::chrono::steady_clock::now();
+    size_t terminating = 0;
+    for (size_t ip = 0; ip < program.size(); ++ip) {
+        auto patched = program;
+        patched[ip] = intcode::flipped(patched[ip]);
+        std::vector<bool> visited(patched.size());
+        intcode::vm vm{};
+        while (vm.ip < patched.size() && !visited[vm.ip]) {
+            visited[vm.ip] = true;
+            intcode::exec(vm, patched[vm.ip]);
+        }
+        terminating += vm.ip == patched.size();
+    }
+    auto const middle = std::chrono::steady_clock::now();
+    intcode::vm_batch batch(program);
+    for (size_t ip = 0; ip < program.size(); ++ip) {
+        batch.add(static_cast<long>(ip));
+    }
+    batch.run();
+    size_t batch_terminating = 0;
+    for (size_t lane = 0; lane < program.size(); ++lane) {
+        batch_terminating += batch.result(lane) == intcode::vm_batch::outcome::terminated;
+    }
+    auto const stop = std::chrono::steady_clock::now();
+
+    auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+    std::cout << "  one at a time: " << ms(middle - start) << " ms (" << terminating << " fixes)" << std::endl;
+    std::cout << "  vm_batch     : " << ms(stop - middle) << " ms (" << batch_terminating << " fixes)" << std::endl;
+}
+
+int main() {
+    for (size_t length : {1'000'000UL, 10'000'000UL}) {
+        auto const program = generate_program(length, 2020);
+        std::cout << length << " instructions" << std::endl;
+        bench("  run_until_end", program, intcode::run_until_end, 5);
+        bench("  run_threaded ", program, intcode::run_threaded, 5);
+        intcode::threaded_program const threaded(program);
+        bench("  threaded_program::run (predecoded)", program, [&](auto const&, intcode::vm& vm) { threaded.run(vm); }, 5);
+        bench("  run_checked  ", program, intcode::run_checked, 5);
+        intcode::jit_program const jit(program);
+        bench(jit.is_compiled() ? "  jit_program::run" : "  jit_program::run (not compiled)", program, [&](auto const&, intcode::vm& vm) { jit.run(vm); }, 5);
+    }
+    bench_patch_search(10'000);
+}
@@ -0,0 +1,221 @@
+#include "gtest/gtest.h"
+#include "intcode.hpp"
+#include "intcode_jit.hpp"
+
+#include <random>
+#include <sstream>
+
+TEST(intcode, parse) {
+    auto acc = intcode::parse("acc +12");
+    EXPECT_EQ(acc.code, intcode::opcode::acc);
+    EXPECT_EQ(acc.argument, 12);
+    auto jmp = intcode::parse("jmp -4");
+    EXPECT_EQ(jmp.code, intcode::opcode::jmp);
+    EXPECT_EQ(jmp.argument, -4);
+    EXPECT_EQ(intcode::parse("nop +0").code, intcode::opcode::nop);
+
+    EXPECT_EQ(intcode::parse("foo +1").code, intcode::opcode::error);
+    EXPECT_EQ(intcode::parse("acc 1").code, intcode::opcode::error);
+    EXPECT_EQ(intcode::parse("acc +").code, intcode::opcode::error);
+    EXPECT_EQ(intcode::parse("acc +1x").code, intcode::opcode::error);
+    EXPECT_EQ(intcode::parse("").code, intcode::opcode::error);
+}
+
+TEST(intcode, run_threaded) {
+    std::vector<intcode::instruction> const program = {
+            intcode::parse("nop +0"),
+            intcode::parse("acc +1"),
+            intcode::parse("jmp +2"),
+            intcode::parse("acc +100"),
+            intcode::parse("acc -3"),
+    };
+    intcode::vm vm1{}, vm2{};
+    intcode::run_until_end(program, vm1);
+    EXPECT_TRUE(intcode::run_threaded(program, vm2));
+    EXPECT_EQ(vm1.acc, -2);
+    EXPECT_EQ(vm2.acc, -2);
+    EXPECT_EQ(vm2.ip, program.size());
+
+    intcode::vm vm3{};
+    EXPECT_FALSE(intcode::run_threaded({intcode::parse("acc +1"), intcode::parse("jmp -5")}, vm3));
+    EXPECT_EQ(vm3.acc, 1);
+}
+
+TEST(intcode, profile) {
+    std::vector<intcode::instruction> const program = {
+            intcode::parse("acc +1"),
+            intcode::parse("jmp +2"),
+            intcode::parse("acc +100"),
+            intcode::parse("jmp +1"),
+    };
+    intcode::profile profile(program.size());
+    intcode::vm vm{.profile = &profile};
+    intcode::run_until_end(program, vm);
+    EXPECT_EQ(vm.acc, 1);
+    EXPECT_EQ(profile.executions, (std::vector<size_t>{1, 1, 0, 1}));
+    EXPECT_EQ(profile.jumps_taken, (std::vector<size_t>{0, 1, 0, 0}));
+
+    std::ostringstream oss;
+    intcode::report_hot_spots(oss, program, profile, 2);
+    EXPECT_EQ(oss.str(),
+              "       0  acc +1  executed 1 (33.3%), jumps taken 0\n"
+              "       1  jmp +2  executed 1 (33.3%), jumps taken 1\n");
+
+    // The caller's formatting is left as it was.
+    oss.str("");
+    oss << 2.25;
+    EXPECT_EQ(oss.str(), "2.25");
+}
+
+TEST(intcode, find_fixes) {
+    std::vector<intcode::instruction> program;
+    for (auto line : {"nop +0", "acc +1", "jmp +4", "acc +3", "jmp -3", "acc -99", "acc +1", "jmp -4", "acc +6"}) {
+        program.push_back(intcode::parse(line));
+    }
+    auto const fixes = intcode::find_fixes(program);
+    ASSERT_EQ(fixes.size(), 1);
+    EXPECT_EQ(fixes[0].ip, 7);
+    EXPECT_EQ(fixes[0].acc, 8);
+
+    program[7] = intcode::flipped(program[7]);
+    EXPECT_TRUE(intcode::find_fixes(program).empty());
+}
+
+TEST(intcode, find_fixes_matches_brute_force) {
+    std::mt19937 rng(8);
+    for (int round = 0; round < 200; ++round) {
+        std::vector<intcode::instruction> program(12);
+        for (auto& instr : program) {
+            instr = {static_cast<intcode::opcode>(1 + rng() % 3), static_cast<long>(rng() % 9) - 4};
+        }
+
+        auto terminates = [](std::vector<intcode::instruction> const& program, intcode::vm& vm) {
+            std::vector<bool> visited(program.size());
+            while (vm.ip < program.size() && !visited[vm.ip]) {
+                visited[vm.ip] = true;
+                intcode::exec(vm, program[vm.ip]);
+            }
+            return vm.ip == program.size();
+        };
+
+        std::vector<std::pair<size_t, long>> expected;
+        for (size_t ip = 0; ip < program.size(); ++ip) {
+            auto patched = program;
+            patched[ip] = intcode::flipped(patched[ip]);
+            intcode::vm vm{};
+            if (program[ip].code != intcode::opcode::acc && terminates(patched, vm)) {
+                expected.emplace_back(ip, vm.acc);
+            }
+        }
+
+        std::vector<std::pair<size_t, long>> actual;
+        for (auto const& fix : intcode::find_fixes(program)) {
+            actual.emplace_back(fix.ip, fix.acc);
+        }
+        intcode::vm vm{};
+        if (terminates(program, vm)) {
+            EXPECT_TRUE(actual.empty());
+        } else {
+            EXPECT_EQ(actual, expected);
+        }
+    }
+}
+
+TEST(intcode, vm_batch) {
+    std::vector<intcode::instruction> program;
+    for (auto line : {"nop +0", "acc +1", "jmp +4", "acc +3", "jmp -3", "acc -99", "acc +1", "jmp -4", "acc +6"}) {
+        program.push_back(intcode::parse(line));
+    }
+    intcode::vm_batch batch(program);
+    size_t const unpatched = batch.add();
+    for (long ip = 0; ip < static_cast<long>(program.size()); ++ip) {
+        batch.add(ip);
+    }
+    batch.run();
+
+    using outcome = intcode::vm_batch::outcome;
+    EXPECT_EQ(batch.result(unpatched), outcome::looped);
+    EXPECT_EQ(batch.result(1 + 0), outcome::looped);
+    EXPECT_EQ(batch.result(1 + 2), outcome::looped);
+    EXPECT_EQ(batch.result(1 + 7), outcome::terminated);
+    EXPECT_EQ(batch.acc(1 + 7), 8);
+
+    intcode::vm_batch escaping({intcode::parse("acc +2"), intcode::parse("jmp -2")});
+    size_t const lane = escaping.add();
+    escaping.run();
+    EXPECT_EQ(escaping.result(lane), outcome::out_of_bounds);
+    EXPECT_EQ(escaping.acc(lane), 2);
+}
+
+TEST(intcode, jit_matches_interpreter) {
+    std::mt19937 rng(33);
+    for (int round = 0; round < 500; ++round) {
+        std::vector<intcode::instruction> program(1 + rng() % 20);
+        for (auto& instr : program) {
+            instr = {static_cast<intcode::opcode>(rng() % 16 == 0 ? 0 : 1 + rng() % 3), static_cast<long>(rng() % 13) - 6};
+        }
+        if (rng() % 4 == 0) {
+            program[rng() % program.size()] = {intcode::opcode::acc, 1L << 40};
+        }
+
+        intcode::jit_program const jit(program);
+        for (size_t start = 0; start < program.size(); ++start) {
+            intcode::vm expected{.acc = 7, .ip = start};
+            intcode::vm actual{.acc = 7, .ip = start};
+            EXPECT_EQ(intcode::run_checked(program, expected), jit.run(actual));
+            EXPECT_EQ(expected.acc, actual.acc);
+            EXPECT_EQ(expected.ip, actual.ip);
+        }
+    }
+}
+
+TEST(intcode, control_flow_graph) {
+    std::vector<intcode::instruction> program;
+    for (auto line : {"nop +0", "acc +1", "jmp +4", "acc +3", "jmp -3", "acc -99", "acc +1", "jmp -4", "acc +6"}) {
+        program.push_back(intcode::parse(line));
+    }
+    auto const cfg = intcode::build_cfg(program);
+    ASSERT_EQ(cfg.blocks.size(), 6);
+    EXPECT_EQ(cfg.blocks[1].begin, 1);
+    EXPECT_EQ(cfg.blocks[1].end, 3);
+    EXPECT_EQ(cfg.blocks[1].acc_delta, 1);
+    EXPECT_EQ(cfg.blocks[1].successor, 4);
+    auto const predecessors = cfg.predecessors.of(4);
+    EXPECT_EQ(std::vector<size_t>(predecessors.begin(), predecessors.end()), (std::vector<size_t>{1, 3}));
+    EXPECT_EQ(cfg.blocks[5].successor, cfg.exit());
+    EXPECT_EQ(cfg.cycles, 1);
+    EXPECT_EQ(cfg.cycle_of[1], cfg.cycle_of[2]);
+    EXPECT_EQ(cfg.cycle_of[1], cfg.cycle_of[4]);
+    EXPECT_EQ(cfg.cycle_of[0], intcode::control_flow_graph::no_cycle);
+    EXPECT_TRUE(cfg.reaches_exit[5]);
+    EXPECT_FALSE(cfg.reaches_exit[3]);
+    EXPECT_FALSE(cfg.terminates());
+
+    intcode::vm vm{};
+    EXPECT_EQ(intcode::run_blocks(cfg, program, vm), intcode::outcome::looped);
+    EXPECT_EQ(vm.acc, 5);
+    EXPECT_EQ(vm.ip, 1);
+}
+
+TEST(intcode, run_blocks_matches_interpreter) {
+    std::mt19937 rng(34);
+    for (int round = 0; round < 500; ++round) {
+        std::vector<intcode::instruction> program(1 + rng() % 20);
+        for (auto& instr : program) {
+            instr = {static_cast<intcode::opcode>(rng() % 16 == 0 ? 0 : 1 + rng() % 3), static_cast<long>(rng() % 13) - 6};
+        }
+
+        auto const cfg = intcode::build_cfg(program);
+        for (size_t start = 0; start < program.size(); ++start) {
+            intcode::vm expected{.ip = start};
+            intcode::vm actual{.ip = start};
+            auto const result = intcode::run_checked(program, expected);
+            EXPECT_EQ(result, intcode::run_blocks(cfg, program, actual));
+            EXPECT_EQ(expected.acc, actual.acc);
+            EXPECT_EQ(expected.ip, actual.ip);
+            if (start == 0) {
+                EXPECT_EQ(cfg.terminates(), result == intcode::outcome::terminated);
+            }
+        }
+    }
+}
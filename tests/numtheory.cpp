@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+#include "numtheory.hpp"
+
+TEST(numtheory, chinese_remainder) {
+    EXPECT_EQ(chinese_remainder(std::vector{2, 3, 2}, std::vector{3, 5, 7}), 23);
+    EXPECT_EQ(chinese_remainder(std::vector{0, 12, 55, 25, 12}, std::vector{7, 13, 59, 31, 19}), 1068781);
+}
+
+TEST(numtheory, non_coprime_moduli) {
+    auto x = solve_congruences({{3, 4}, {5, 6}});
+    ASSERT_TRUE(x);
+    EXPECT_EQ(x->to_long(), 11);
+    EXPECT_FALSE(solve_congruences({{1, 4}, {2, 6}}));
+    EXPECT_FALSE(solve_congruences({{1, 8}, {2, 4}}));
+}
+
+TEST(numtheory, large_moduli) {
+    long const p = 1000000000000000003;
+    long const q = 999999999999999989;
+    auto x = solve_congruences({{1, p}, {2, q}});
+    ASSERT_TRUE(x);
+    EXPECT_FALSE(x->fits_long());
+    big_unsigned copy = *x;
+    EXPECT_EQ(copy.divide(p), 1);
+    copy = *x;
+    EXPECT_EQ(copy.divide(q), 2);
+
+    // Shared factors between moduli past 2^63, and a contradiction hidden behind one.
+    x = solve_congruences({{5, 4 * q}, {7, 6 * p}, {1, 8}});
+    ASSERT_TRUE(x);
+    for (auto [r, m] : {std::pair{5L, 4 * q}, {7L, 6 * p}, {1L, 8L}}) {
+        copy = *x;
+        EXPECT_EQ(copy.divide(m), r);
+    }
+    EXPECT_FALSE(solve_congruences({{5, 4 * q}, {7, 6 * p}, {2, 8}}));
+}
+
+TEST(numtheory, big_result) {
+    // x = -1 modulo the first 40 primes, so x + 1 is their product.
+    std::vector<congruence> congruences;
+    big_unsigned product(1);
+    for (long p = 2; congruences.size() < 40; ++p) {
+        bool prime = true;
+        for (long d = 2; d * d <= p; ++d) {
+            prime = prime && p % d != 0;
+        }
+        if (prime) {
+            congruences.push_back({-1, p});
+            product *= p;
+        }
+    }
+    auto x = solve_congruences(congruences);
+    ASSERT_TRUE(x);
+    EXPECT_FALSE(x->fits_long());
+    *x += 1;
+    EXPECT_EQ(*x, product);
+    EXPECT_EQ(big_unsigned(1'000'000'007UL).to_string(), "1000000007");
+}
@@ -0,0 +1,184 @@
+#include "gtest/gtest.h"
+#include "day07.hpp"
+
+#include <random>
+
+namespace {
+    // Random rules over bags "b0".."b{n-1}". Edges mostly point to higher-numbered bags; with
+    // back_edges set some point anywhere, self-loops included, so the rules may be cyclic.
+    std::vector<bag_rule> random_rules(std::mt19937& rng, int n, bool back_edges) {
+        std::vector<bag_rule> rules;
+        for (int i = 0; i < n; ++i) {
+            bag_rule rule{"b" + std::to_string(i), {}};
+            std::vector<bool> used(n, false);
+            int const nr_edges = std::uniform_int_distribution<int>(0, 3)(rng);
+            for (int k = 0; k < nr_edges; ++k) {
+                int to;
+                if (back_edges && std::uniform_int_distribution<int>(0, 4)(rng) == 0) {
+                    to = std::uniform_int_distribution<int>(0, n-1)(rng);
+                } else if (i + 1 < n) {
+                    to = std::uniform_int_distribution<int>(i+1, n-1)(rng);
+                } else {
+                    continue;
+                }
+                if (!used[to]) {
+                    used[to] = true;
+                    rule.contents.emplace_back(std::uniform_int_distribution<int>(1, 3)(rng), "b" + std::to_string(to));
+                }
+            }
+            rules.push_back(rule);
+        }
+        return rules;
+    }
+
+    bag_graph build_graph(std::vector<bag_rule> const& rules) {
+        bag_graph_builder builder;
+        for (auto const& rule : rules) {
+            builder.intern(rule.container);
+        }
+        for (auto const& rule : rules) {
+            builder.add_rule(rule);
+        }
+        return builder.build();
+    }
+
+    // Reference: plain recursive DFS, 0 for bags on or containing a cycle.
+    size_t reference_total(bag_graph const& graph, bag_id bag, std::vector<int>& state, std::vector<size_t>& memo) {
+        if (state[bag] == 2) {
+            return memo[bag];
+        }
+        if (state[bag] == 1) {
+            return 0;
+        }
+        state[bag] = 1;
+        size_t total = 1;
+        for (auto const& [count, contents] : graph.contents_of(bag)) {
+            size_t const inner = reference_total(graph, contents, state, memo);
+            if (inner == 0) {
+                total = 0;
+                break;
+            }
+            total += count * inner;
+        }
+        state[bag] = 2;
+        memo[bag] = total;
+        return total;
+    }
+
+    // Reference: every bag reachable through containers_of, not counting the start bag itself.
+    size_t reference_contained_by(bag_graph const& graph, bag_id start) {
+        std::vector<bool> seen(graph.size(), false);
+        std::vector<bag_id> stack{start};
+        size_t count = 0;
+        while (!stack.empty()) {
+            bag_id const bag = stack.back();
+            stack.pop_back();
+            for (bag_id container : graph.containers_of(bag)) {
+                if (!seen[container]) {
+                    seen[container] = true;
+                    count += container != start;
+                    stack.push_back(container);
+                }
+            }
+        }
+        return count;
+    }
+}
+
+TEST(day07, parse_rule) {
+    auto rule = parse_rule("light red bags contain 1 bright white bag, 2 muted yellow bags.");
+    EXPECT_EQ(rule.container, "light red");
+    ASSERT_EQ(rule.contents.size(), 2);
+    EXPECT_EQ(rule.contents[0], (std::pair<int, std::string>(1, "bright white")));
+    EXPECT_EQ(rule.contents[1], (std::pair<int, std::string>(2, "muted yellow")));
+
+    EXPECT_TRUE(parse_rule("faded blue bags contain no other bags.").contents.empty());
+}
+
+TEST(day07, mutable_bag_graph) {
+    mutable_bag_graph graph;
+    graph.add_rule(parse_rule("shiny gold bags contain 2 dark red bags."));
+    graph.add_rule(parse_rule("dark red bags contain 2 dark orange bags."));
+    graph.add_rule(parse_rule("light red bags contain 1 shiny gold bag."));
+    EXPECT_EQ(graph.nr_contains("shiny gold"), 6);
+    EXPECT_EQ(graph.nr_contained_by("shiny gold"), 1);
+    EXPECT_EQ(graph.nr_contained_by("dark orange"), 3);
+
+    graph.add_rule(parse_rule("dark orange bags contain 3 dark yellow bags."));
+    EXPECT_EQ(graph.nr_contains("shiny gold"), 18);
+    EXPECT_EQ(graph.nr_contained_by("dark yellow"), 4);
+
+    graph.replace_rule(parse_rule("dark red bags contain 1 dark yellow bag."));
+    EXPECT_EQ(graph.nr_contains("shiny gold"), 4);
+    EXPECT_EQ(graph.nr_contained_by("dark orange"), 0);
+    EXPECT_EQ(graph.nr_contained_by("dark yellow"), 4);
+
+    graph.remove_rule("light red");
+    EXPECT_EQ(graph.nr_contained_by("shiny gold"), 0);
+    EXPECT_EQ(graph.nr_contained_by("dark yellow"), 3);
+    EXPECT_EQ(graph.nr_contains("shiny gold"), 4);
+}
+
+TEST(day07, mutable_bag_graph_cycles) {
+    for (bool a_first : {true, false}) {
+        mutable_bag_graph graph;
+        graph.add_rule(parse_rule("light red bags contain 1 dark red bag."));
+        graph.add_rule(parse_rule("dark red bags contain 1 light red bag."));
+        graph.add_rule(parse_rule("shiny gold bags contain 2 light red bags, 1 dark blue bag."));
+        graph.add_rule(parse_rule("dark blue bags contain 3 faded blue bags."));
+        // Bags on or containing a cycle have no finite answer and count 0, whatever the order.
+        if (a_first) {
+            EXPECT_EQ(graph.nr_contains("light red"), 0);
+        }
+        EXPECT_EQ(graph.nr_contains("shiny gold"), 0);
+        EXPECT_EQ(graph.nr_contains("dark red"), 0);
+        EXPECT_EQ(graph.nr_contains("light red"), 0);
+        EXPECT_EQ(graph.nr_contains("dark blue"), 3);
+
+        // Breaking the cycle gives finite answers again.
+        graph.replace_rule(parse_rule("dark red bags contain 2 faded blue bags."));
+        EXPECT_EQ(graph.nr_contains("light red"), 3);
+        EXPECT_EQ(graph.nr_contains("dark red"), 2);
+        EXPECT_EQ(graph.nr_contains("shiny gold"), 12);
+    }
+
+    mutable_bag_graph self;
+    self.add_rule(parse_rule("plain bags contain 1 plain bag."));
+    EXPECT_EQ(self.nr_contains("plain"), 0);
+    EXPECT_EQ(self.nr_contained_by("plain"), 0);
+}
+
+TEST(day07, add_rule_replaces) {
+    mutable_bag_graph graph;
+    graph.add_rule(parse_rule("light red bags contain 2 dark red bags."));
+    graph.add_rule(parse_rule("light red bags contain 2 dark red bags."));
+    EXPECT_EQ(graph.nr_contains("light red"), 2);
+    EXPECT_EQ(graph.nr_contained_by("dark red"), 1);
+}
+
+TEST(day07, bag_totals_matches_dfs) {
+    std::mt19937 rng(7);
+    for (int trial = 0; trial < 200; ++trial) {
+        int const n = std::uniform_int_distribution<int>(1, 15)(rng);
+        bag_graph const graph = build_graph(random_rules(rng, n, trial % 2 == 1));
+        std::vector<size_t> const totals = bag_totals(graph);
+        for (bag_id bag = 0; bag < n; ++bag) {
+            std::vector<int> state(n, 0);
+            std::vector<size_t> memo(n, 0);
+            ASSERT_EQ(totals[bag], reference_total(graph, bag, state, memo)) << "trial " << trial << ", bag " << bag;
+        }
+    }
+}
+
+TEST(day07, containment_index_matches_dfs) {
+    std::mt19937 rng(27);
+    for (int trial = 0; trial < 200; ++trial) {
+        // Up to 150 bags, so the bitset rows span several words.
+        int const n = std::uniform_int_distribution<int>(1, trial < 150 ? 15 : 150)(rng);
+        bag_graph const graph = build_graph(random_rules(rng, n, trial % 2 == 1));
+        containment_index const index(graph);
+        for (bag_id bag = 0; bag < n; ++bag) {
+            ASSERT_EQ(index.nr_contained_by(bag), reference_contained_by(graph, bag)) << "trial " << trial << ", bag " << bag;
+        }
+    }
+}
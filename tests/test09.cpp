@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+#include "day09.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+    std::vector<long> const example{
+            35, 20, 15, 25, 47, 40, 62, 55, 65, 95, 102, 117, 150, 182, 127, 219, 299, 277, 309, 576};
+}
+
+TEST(day09, example) {
+    EXPECT_EQ(find_invalid(example, 5), 127);
+    auto const range = find_range_summing_to(example, 127);
+    ASSERT_TRUE(range);
+    EXPECT_EQ(range->first, 2);
+    EXPECT_EQ(range->last, 5);
+    EXPECT_EQ(range->smallest + range->largest, 62);
+}
+
+TEST(day09, window_size) {
+    xmas_window window(2);
+    EXPECT_TRUE(window.push(1));
+    EXPECT_TRUE(window.push(2));
+    EXPECT_TRUE(window.is_full());
+    EXPECT_TRUE(window.push(3));
+    // 1 has left the window, so 1 + 3 is no longer a pair.
+    EXPECT_FALSE(window.push(4));
+    EXPECT_TRUE(window.push(7));
+
+    std::vector<long> const numbers{1, 2, 3, 4, 5, 100};
+    EXPECT_EQ(find_invalid(numbers, 2), 4);
+    EXPECT_EQ(find_invalid(numbers, 3), 100);
+    EXPECT_EQ(find_invalid(std::vector<long>{1, 2, 3}, 5), -1);
+}
+
+TEST(day09, pair_of_equal_numbers) {
+    // 10 = 5 + 5 needs two 5s in the window; one is not enough.
+    xmas_window single(3);
+    for (long x : {5, 1, 2}) {
+        single.push(x);
+    }
+    EXPECT_FALSE(single.push(10));
+
+    xmas_window twice(3);
+    for (long x : {5, 1, 5}) {
+        twice.push(x);
+    }
+    EXPECT_TRUE(twice.push(10));
+    // The first 5 has been evicted, leaving 1, 5, 10.
+    EXPECT_FALSE(twice.push(10));
+}
+
+TEST(day09, range_with_repeated_extremes) {
+    // Dropping the first 1 must leave the second one as the minimum of the run.
+    auto const range = find_range_summing_to(std::vector<long>{1, 1, 5, 5, 1, 1}, 11);
+    ASSERT_TRUE(range);
+    EXPECT_EQ(range->first, 1);
+    EXPECT_EQ(range->last, 3);
+    EXPECT_EQ(range->smallest, 1);
+    EXPECT_EQ(range->largest, 5);
+}
+
+TEST(day09, range_matches_brute_force) {
+    std::mt19937 rng(9);
+    for (int round = 0; round < 500; ++round) {
+        // Small values, so runs are full of repeats and zeros.
+        std::vector<long> numbers(rng() % 20);
+        for (long& x : numbers) {
+            x = rng() % 5;
+        }
+        long const target = rng() % 15;
+
+        std::optional<xmas_range> expected;
+        for (size_t last = 1; last < numbers.size() && !expected; ++last) {
+            for (size_t first = 0; first < last && !expected; ++first) {
+                long sum = 0;
+                for (size_t i = first; i <= last; ++i) {
+                    sum += numbers[i];
+                }
+                if (sum == target) {
+                    auto const [min, max] = std::minmax_element(numbers.begin() + first, numbers.begin() + last + 1);
+                    expected = xmas_range{first, last, *min, *max};
+                }
+            }
+        }
+
+        auto const range = find_range_summing_to(numbers, target);
+        ASSERT_EQ(range.has_value(), expected.has_value()) << "round " << round;
+        if (range) {
+            EXPECT_EQ(range->first, expected->first);
+            EXPECT_EQ(range->last, expected->last);
+            EXPECT_EQ(range->smallest, expected->smallest);
+            EXPECT_EQ(range->largest, expected->largest);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#include "gtest/gtest.h"
+#include "day10.hpp"
+
+#include <random>
+
+namespace {
+    // Chains by depth-first search, for small inputs.
+    size_t brute_force_chains(std::vector<int> const& sorted, int max_gap, size_t from = 0, int jolts = 0) {
+        if (!sorted.empty() && jolts == sorted.back()) {
+            return 1;
+        }
+        size_t count = 0;
+        for (size_t i = from; i < sorted.size() && sorted[i] - jolts <= max_gap; ++i) {
+            count += brute_force_chains(sorted, max_gap, i + 1, sorted[i]);
+        }
+        return count;
+    }
+}
+
+TEST(day10, count_chains) {
+    auto const adapters = sorted_adapters({16, 10, 15, 5, 1, 11, 7, 19, 6, 12, 4});
+    EXPECT_EQ(count_chains(adapters), big_unsigned(8));
+    EXPECT_EQ(count_chains_modulo(adapters, 3, 5), 3);
+    EXPECT_EQ(count_chains({}), big_unsigned(1));
+}
+
+TEST(day10, count_chains_other_gaps) {
+    std::mt19937 rng(10);
+    for (int max_gap : {1, 2, 4, 6}) {
+        for (int i = 0; i < 20; ++i) {
+            std::vector<int> adapters;
+            for (int jolts = 0; adapters.size() < 16;) {
+                jolts += 1 + rng() % max_gap;
+                adapters.push_back(jolts);
+            }
+            EXPECT_EQ(count_chains(adapters, max_gap), big_unsigned(brute_force_chains(adapters, max_gap)));
+        }
+    }
+}
+
+TEST(day10, count_chains_exact) {
+    // 1..300 with gaps of 3: far more chains than fit in 64 bits.
+    std::vector<int> adapters(300);
+    std::iota(adapters.begin(), adapters.end(), 1);
+    big_unsigned chains = count_chains(adapters);
+    EXPECT_FALSE(chains.fits_long());
+    size_t const modulus = 1'000'000'007;
+    EXPECT_EQ(chains.divide(modulus), count_chains_modulo(adapters, 3, modulus));
+}
+
+TEST(day10, sorted_adapters_sparse) {
+    // A range far wider than the number of adapters takes the comparison sort.
+    std::vector<int> const adapters{2000000000, 3, 1000000, 3, 7, 2000000000, 1};
+    EXPECT_EQ(sorted_adapters(adapters), (std::vector<int>{1, 3, 7, 1000000, 2000000000}));
+    EXPECT_EQ(sorted_adapters({5, 3, 4, 3}), (std::vector<int>{3, 4, 5}));
+}
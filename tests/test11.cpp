@@ -0,0 +1,76 @@
+#include "gtest/gtest.h"
+#include "day11.hpp"
+
+#include <random>
+
+namespace {
+    seating_area random_area(std::mt19937& rng, int rows, int cols) {
+        seating_area area{std::vector<seat>(static_cast<size_t>(rows) * cols), cols};
+        for (seat& s : area.seats) {
+            s = static_cast<seat>(rng() % 3);
+        }
+        return area;
+    }
+
+    template<class F>
+    seating_area reference_until_stable(seating_area area, F evolve_fn) {
+        seating_area next = area;
+        while (true) {
+            for (int row = 0; row < area.height(); ++row) {
+                for (int col = 0; col < area.width(); ++col) {
+                    seat const s = area.get(row, col);
+                    next.seats[row * area.width() + col] = evolve_fn(area, row, col) ? evolved(s) : s;
+                }
+            }
+            if (next.seats == area.seats) {
+                return area;
+            }
+            std::swap(area, next);
+        }
+    }
+}
+
+TEST(day11, neighbour_rules_match_reference) {
+    std::mt19937 rng(11);
+    for (int round = 0; round < 20; ++round) {
+        seating_area const area = random_area(rng, 1 + rng() % 30, 1 + rng() % 30);
+        auto const adjacent = adjacent_seats(area);
+        auto const visible = visible_seats(area);
+        EXPECT_EQ(evolve_until_stable(area, neighbour_rule{adjacent, 4}).seats,
+                  reference_until_stable(area, evolve_close).seats);
+        EXPECT_EQ(evolve_until_stable(area, neighbour_rule{visible, 5}).seats,
+                  reference_until_stable(area, evolve_line_of_sight).seats);
+    }
+}
+
+TEST(day11, parallel_matches_serial) {
+    std::mt19937 rng(12);
+    for (unsigned threads : {1U, 2U, 3U, 8U, 64U}) {
+        seating_area const area = random_area(rng, 1 + rng() % 40, 1 + rng() % 40);
+        auto const visible = visible_seats(area);
+        EXPECT_EQ(evolve_until_stable_parallel(area, neighbour_rule{visible, 5}, threads).seats,
+                  evolve_until_stable(area, neighbour_rule{visible, 5}).seats);
+    }
+}
+
+TEST(day11, bitsliced_matches_reference) {
+    std::mt19937 rng(13);
+    for (int round = 0; round < 20; ++round) {
+        seating_area const area = random_area(rng, 1 + rng() % 30, 1 + rng() % 150);
+        EXPECT_EQ(evolve_until_stable_bitsliced(area, false, 4).seats,
+                  reference_until_stable(area, evolve_close).seats);
+        EXPECT_EQ(evolve_until_stable_bitsliced(area, true, 5).seats,
+                  reference_until_stable(area, evolve_line_of_sight).seats);
+    }
+}
+
+TEST(day11, worklist_matches_reference) {
+    std::mt19937 rng(14);
+    for (int round = 0; round < 20; ++round) {
+        seating_area const area = random_area(rng, 1 + rng() % 30, 1 + rng() % 30);
+        EXPECT_EQ(evolve_until_stable_worklist(area, adjacent_seats(area), 4).seats,
+                  reference_until_stable(area, evolve_close).seats);
+        EXPECT_EQ(evolve_until_stable_worklist(area, visible_seats(area), 5).seats,
+                  reference_until_stable(area, evolve_line_of_sight).seats);
+    }
+}
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include "day12.hpp"
+
+#include <random>
+
+namespace {
+    std::vector<action> random_actions(std::mt19937& rng, size_t size) {
+        std::string const instructions = "NSEWLRF";
+        std::vector<action> actions(size);
+        for (action& a : actions) {
+            a.instruction = instructions[rng() % instructions.size()];
+            a.amount = a.instruction == 'L' || a.instruction == 'R' ? 90 * (1 + rng() % 3) : 1 + rng() % 100;
+        }
+        return actions;
+    }
+
+    vec2 rotate_left(vec2 v, int degrees) {
+        for (; degrees > 0; degrees -= 90) {
+            v = {-v.y, v.x};
+        }
+        return v;
+    }
+
+    // Reference: the puzzle rules applied one action at a time.
+    std::vector<nav_state> reference_states(std::vector<action> const& actions, rules rules, nav_state state) {
+        std::vector<nav_state> states;
+        for (action const& a : actions) {
+            vec2& moved = rules == rules::facing ? state.ship : state.vector;
+            switch (a.instruction) {
+            case 'N': moved.y += a.amount; break;
+            case 'S': moved.y -= a.amount; break;
+            case 'E': moved.x += a.amount; break;
+            case 'W': moved.x -= a.amount; break;
+            case 'L': state.vector = rotate_left(state.vector, a.amount); break;
+            case 'R': state.vector = rotate_left(state.vector, 360 - a.amount); break;
+            case 'F': state.ship = {state.ship.x + a.amount * state.vector.x, state.ship.y + a.amount * state.vector.y}; break;
+            }
+            states.push_back(state);
+        }
+        return states;
+    }
+
+    void expect_same(nav_state const& a, nav_state const& b) {
+        EXPECT_EQ(a.ship.x, b.ship.x);
+        EXPECT_EQ(a.ship.y, b.ship.y);
+        EXPECT_EQ(a.vector.x, b.vector.x);
+        EXPECT_EQ(a.vector.y, b.vector.y);
+    }
+}
+
+TEST(day12, example) {
+    std::vector<action> actions;
+    for (char const* line : {"F10", "N3", "F7", "R90", "F11"}) {
+        actions.push_back(parse_action(line));
+    }
+    nav_state const facing = navigate(actions, rules::facing, {{0, 0}, {1, 0}}, 2);
+    EXPECT_EQ(std::abs(facing.ship.x) + std::abs(facing.ship.y), 25);
+    nav_state const waypoint = navigate(actions, rules::waypoint, {{0, 0}, {10, 1}}, 2);
+    EXPECT_EQ(std::abs(waypoint.ship.x) + std::abs(waypoint.ship.y), 286);
+}
+
+TEST(day12, navigate_matches_reference) {
+    std::mt19937 rng(12);
+    for (int round = 0; round < 30; ++round) {
+        std::vector<action> const actions = random_actions(rng, rng() % 200);
+        for (rules rules : {rules::facing, rules::waypoint}) {
+            nav_state const initial = rules == rules::facing ? nav_state{{0, 0}, {1, 0}} : nav_state{{0, 0}, {10, 1}};
+            std::vector<nav_state> const expected = reference_states(actions, rules, initial);
+            // Includes more threads than actions, which navigate clamps to one action per chunk.
+            for (unsigned nr_threads : {1U, 2U, 3U, 4U, 7U, 300U}) {
+                std::vector<nav_state> states;
+                nav_state const final_state = navigate(actions, rules, initial, nr_threads, &states);
+                expect_same(final_state, expected.empty() ? initial : expected.back());
+                ASSERT_EQ(states.size(), expected.size());
+                for (size_t i = 0; i < states.size(); ++i) {
+                    expect_same(states[i], expected[i]);
+                }
+            }
+        }
+    }
+}
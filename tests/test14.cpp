@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include "day14.hpp"
+
+#include <random>
+#include <set>
+
+namespace {
+    // Every address in a pattern, as explode_mask used to list them.
+    std::vector<unsigned long> explode(address_pattern const& pattern) {
+        std::vector<unsigned long> addresses{pattern.fixed & ~pattern.floating};
+        for (unsigned long bits = pattern.floating; bits != 0; bits &= bits - 1) {
+            unsigned long const bit = bits & -bits;
+            size_t const size = addresses.size();
+            for (size_t i = 0; i < size; ++i) {
+                addresses.push_back(addresses[i] | bit);
+            }
+        }
+        return addresses;
+    }
+
+    // A pattern over the low 8 bits, so that random patterns overlap often.
+    address_pattern random_pattern(std::mt19937& rng) {
+        unsigned long const floating = rng() & rng() & 0xff;
+        return {rng() & 0xff & ~floating, floating};
+    }
+}
+
+TEST(day14, subtract_pattern) {
+    std::mt19937 rng(14);
+    for (int i = 0; i < 500; ++i) {
+        address_pattern const from = random_pattern(rng);
+        address_pattern const removed = random_pattern(rng);
+        std::set<unsigned long> expected;
+        for (unsigned long address : explode(from)) {
+            auto const removed_addresses = explode(removed);
+            if (std::find(removed_addresses.begin(), removed_addresses.end(), address) == removed_addresses.end()) {
+                expected.insert(address);
+            }
+        }
+
+        std::set<unsigned long> actual;
+        size_t total = 0;
+        subtract_pattern(from, removed, [&](address_pattern const& p) {
+            auto const addresses = explode(p);
+            total += addresses.size();
+            actual.insert(addresses.begin(), addresses.end());
+        });
+        EXPECT_EQ(actual, expected);
+        EXPECT_EQ(total, actual.size());
+    }
+}
+
+TEST(day14, floating_memory) {
+    std::mt19937 rng(41);
+    for (int i = 0; i < 50; ++i) {
+        floating_memory memory;
+        std::unordered_map<unsigned long, unsigned long> reference;
+        for (int w = 0; w < 20; ++w) {
+            address_pattern const pattern = random_pattern(rng);
+            unsigned long const value = rng() % 1000;
+            memory.write(pattern, value);
+            for (unsigned long address : explode(pattern)) {
+                reference[address] = value;
+            }
+        }
+        unsigned long expected = 0;
+        for (auto const& [address, value] : reference) {
+            expected += value;
+        }
+        EXPECT_EQ(memory.sum(), expected);
+    }
+}
+
+TEST(day14, floating_memory_fragments) {
+    // The documented worst case: each write fixes a new 4-bit group of an all-X pattern, and the
+    // live pattern count grows fourfold.
+    floating_memory memory;
+    memory.write({0, address_bits}, 1);
+    for (size_t group = 0; group < 3; ++group) {
+        unsigned long const bits = 0xfUL << (4 * group);
+        memory.write({0, address_bits & ~bits}, 2);
+    }
+    EXPECT_EQ(memory.nr_patterns(), 85);
+    // Addresses with none of the three groups zero keep the 1.
+    unsigned long const untouched = (1UL << 36) / 4096 * 15 * 15 * 15;
+    EXPECT_EQ(memory.sum(), 2 * ((1UL << 36) - untouched) + untouched);
+}
@@ -0,0 +1,26 @@
+#include "gtest/gtest.h"
+#include "day15.hpp"
+
+TEST(day15, play_memory_game) {
+    EXPECT_EQ(play_memory_game({0, 3, 6}, 2020, {1, 3, 4, 10, 2020}), (std::vector<uint32_t>{0, 6, 0, 0, 436}));
+    EXPECT_EQ(play_memory_game({3, 1, 2}, 2020, {2020}), (std::vector<uint32_t>{1836}));
+    EXPECT_EQ(play_memory_game({1, 1}, 5, {2, 3, 4, 5}), (std::vector<uint32_t>{1, 1, 1, 1}));
+}
+
+TEST(day15, tiered_last_seen) {
+    // A tiny dense tier pushes most numbers into the table.
+    tiered_last_seen last_seen(memory_game_numbers({0, 3, 6}, 20000), 64 * 1024);
+    EXPECT_EQ(play_memory_game({0, 3, 6}, 20000, {2020, 20000}, last_seen), play_memory_game({0, 3, 6}, 20000, {2020, 20000}));
+
+    tiered_last_seen too_small(memory_game_numbers({0, 3, 6}, 1000000), 16 * 1024);
+    EXPECT_THROW(play_memory_game({0, 3, 6}, 1000000, {1000000}, too_small), std::length_error);
+}
+
+TEST(day15, invalid_checkpoints) {
+    EXPECT_THROW(play_memory_game({0, 3, 6}, 2020, {0}), std::invalid_argument);
+    EXPECT_THROW(play_memory_game({0, 3, 6}, 2020, {0, 10}), std::invalid_argument);
+    EXPECT_THROW(play_memory_game({0, 3, 6}, 2020, {10, 4}), std::invalid_argument);
+    EXPECT_THROW(play_memory_game({0, 3, 6}, 2020, {10, 2021}), std::invalid_argument);
+    EXPECT_EQ(play_memory_game({0, 3, 6}, 2020, {2020}), std::vector<uint32_t>{436});
+    EXPECT_EQ(play_memory_game({0, 3, 6}, 2020, {}), std::vector<uint32_t>{});
+}
@@ -0,0 +1,81 @@
+#include "gtest/gtest.h"
+#include "day16.hpp"
+
+#include <sstream>
+
+namespace {
+    problem_t example(std::string const& rules, std::string const& nearby) {
+        std::istringstream is(rules +
+                              "\n"
+                              "your ticket:\n"
+                              "11,12,13\n"
+                              "\n"
+                              "nearby tickets:\n" + nearby);
+        return parse_problem(is);
+    }
+
+    // Column c can be field c or field c+1 (mod n): no column has a single candidate.
+    std::vector<uint64_t> cyclic_candidates(size_t n) {
+        size_t const words = (n + 63) / 64;
+        std::vector<uint64_t> candidates(n * words);
+        for (size_t c = 0; c < n; ++c) {
+            for (size_t field : {c, (c + 1) % n}) {
+                candidates[c * words + field / 64] |= uint64_t{1} << (field % 64);
+            }
+        }
+        return candidates;
+    }
+
+    void expect_valid_assignment(std::vector<uint64_t> const& candidates, size_t words, std::vector<int> const& fields) {
+        std::vector<bool> used(words * 64);
+        for (size_t c = 0; c < fields.size(); ++c) {
+            ASSERT_GE(fields[c], 0);
+            EXPECT_TRUE((candidates[c * words + fields[c] / 64] >> (fields[c] % 64)) & 1);
+            EXPECT_FALSE(used[fields[c]]);
+            used[fields[c]] = true;
+        }
+    }
+}
+
+TEST(day16, label_tickets) {
+    problem_t const problem = example("class: 0-1 or 4-19\nrow: 0-5 or 8-19\nseat: 0-13 or 16-19\n", "3,9,18\n15,1,5\n5,14,9\n");
+    auto const labeling = label_tickets(problem.nearby_tickets, problem.your_ticket.size(), problem.constraints, 2);
+    ASSERT_TRUE(labeling);
+    EXPECT_EQ(*labeling, (std::vector<int>{1, 0, 2}));
+}
+
+TEST(day16, label_tickets_uses_your_ticket_length) {
+    // A short first nearby ticket must not decide the number of columns.
+    problem_t const problem = example("class: 0-1 or 4-19\nrow: 0-5 or 8-19\nseat: 0-13 or 16-19\n", "3,9\n3,9,18\n15,1,5\n5,14,9\n");
+    auto const labeling = label_tickets(problem.nearby_tickets, problem.your_ticket.size(), problem.constraints, 2);
+    ASSERT_TRUE(labeling);
+    EXPECT_EQ(*labeling, (std::vector<int>{1, 0, 2}));
+
+    auto const without_tickets = label_tickets({}, 3, problem.constraints, 1);
+    ASSERT_TRUE(without_tickets);
+    EXPECT_EQ(without_tickets->size(), 3);
+}
+
+TEST(day16, label_tickets_without_valid_tickets) {
+    problem_t const problem = example("class: 1-3 or 5-7\nrow: 6-11 or 33-44\nseat: 13-40 or 45-50\n", "7,3,47\n40,4,50\n55,2,20\n38,6,12\n");
+    EXPECT_EQ(ticket_scanning_error_rate(problem.nearby_tickets, field_lut(problem.constraints)), 71);
+    auto const labeling = label_tickets(problem.nearby_tickets, problem.your_ticket.size(), problem.constraints, 1);
+    ASSERT_TRUE(labeling);
+    for (int field : *labeling) {
+        EXPECT_LT(field, 3);
+    }
+}
+
+TEST(day16, assign_fields_matching) {
+    for (size_t n : {2, 5, 130}) {
+        size_t const words = (n + 63) / 64;
+        auto const candidates = cyclic_candidates(n);
+        auto const fields = assign_fields(candidates, words, n, n);
+        ASSERT_TRUE(fields);
+        ASSERT_EQ(fields->size(), n);
+        expect_valid_assignment(candidates, words, *fields);
+    }
+
+    // Two columns that can only be field 0.
+    EXPECT_FALSE(assign_fields({1, 1, 6}, 1, 3, 3));
+}